@@ -0,0 +1,203 @@
+#include "FloorplanTransformer.hpp"
+#include <benchmark/benchmark.h>
+#include <cmath>
+
+using namespace uwb_transform;
+
+namespace {
+
+// Representative production config (rotation + flips), matching transform_config.json
+TransformConfig makeRotatedConfig() {
+    return TransformConfig(-1215.0, 29105.0, 0.0385, 0.068, false, true);
+}
+
+// Degenerate config: no rotation, no flips - the common "axis-aligned floorplan" case
+TransformConfig makeAxisAlignedConfig() {
+    return TransformConfig(-1215.0, 29105.0, 0.0385, 0.0, false, false);
+}
+
+} // namespace
+
+// --- Single-point transforms ---------------------------------------------
+
+static void BM_TransformSinglePoint(benchmark::State& state) {
+    FloorplanTransformer transformer(makeRotatedConfig());
+    double x = 4396.0, y = 17537.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(transformer.transformToPixel(x, y));
+        x += 0.001;  // Defeat value caching across iterations
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TransformSinglePoint);
+
+static void BM_TransformSinglePointNoRotation(benchmark::State& state) {
+    FloorplanTransformer transformer(makeAxisAlignedConfig());
+    double x = 4396.0, y = 17537.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(transformer.transformToPixel(x, y));
+        x += 0.001;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TransformSinglePointNoRotation);
+
+// With axis flips but no rotation: still dispatches to the axis-aligned
+// kernel (flips only negate the matrix diagonal)
+static void BM_TransformSinglePointFlippedNoRotation(benchmark::State& state) {
+    FloorplanTransformer transformer(
+        TransformConfig(-1215.0, 29105.0, 0.0385, 0.0, true, true));
+    double x = 4396.0, y = 17537.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(transformer.transformToPixel(x, y));
+        x += 0.001;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TransformSinglePointFlippedNoRotation);
+
+static void BM_TransformInverse(benchmark::State& state) {
+    FloorplanTransformer transformer(makeRotatedConfig());
+    double x = 0.5, y = 0.7;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(transformer.transformToUWB(x, y));
+        x += 0.00001;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TransformInverse);
+
+// --- Batched transforms ---------------------------------------------------
+
+static void BM_TransformBatch(benchmark::State& state) {
+    FloorplanTransformer transformer(makeRotatedConfig());
+    const Eigen::Index n = state.range(0);
+
+    Eigen::Matrix2Xd points(2, n);
+    for (Eigen::Index i = 0; i < n; ++i) {
+        points(0, i) = 500.0 + 13.0 * static_cast<double>(i);
+        points(1, i) = 900.0 + 7.0 * static_cast<double>(i);
+    }
+    Eigen::Matrix2Xd out(2, n);
+
+    for (auto _ : state) {
+        transformer.transformToPixelBatch(points, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+// Burst sizes we actually see: one position per tag, 50-200 tags per burst
+BENCHMARK(BM_TransformBatch)->Arg(8)->Arg(32)->Arg(64)->Arg(128)->Arg(256);
+
+// Same batch sizes through the axis-aligned kernel, to show the win per
+// config class next to the general-matrix numbers above
+static void BM_TransformBatchNoRotation(benchmark::State& state) {
+    FloorplanTransformer transformer(makeAxisAlignedConfig());
+    const Eigen::Index n = state.range(0);
+
+    Eigen::Matrix2Xd points(2, n);
+    for (Eigen::Index i = 0; i < n; ++i) {
+        points(0, i) = 500.0 + 13.0 * static_cast<double>(i);
+        points(1, i) = 900.0 + 7.0 * static_cast<double>(i);
+    }
+    Eigen::Matrix2Xd out(2, n);
+
+    for (auto _ : state) {
+        transformer.transformToPixelBatch(points, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_TransformBatchNoRotation)->Arg(8)->Arg(32)->Arg(64)->Arg(128)->Arg(256);
+
+// Full 3D batch through the homogeneous matrix: same X/Y work as the 2D
+// batch plus the fused Z row, so the delta here is the cost of native Z
+static void BM_TransformBatch3D(benchmark::State& state) {
+    FloorplanTransformer transformer(makeRotatedConfig());
+    const Eigen::Index n = state.range(0);
+
+    Eigen::Matrix3Xd points(3, n);
+    for (Eigen::Index i = 0; i < n; ++i) {
+        points(0, i) = 500.0 + 13.0 * static_cast<double>(i);
+        points(1, i) = 900.0 + 7.0 * static_cast<double>(i);
+        points(2, i) = 1200.0 + 3.0 * static_cast<double>(i);
+    }
+    Eigen::Matrix3Xd out(3, n);
+
+    for (auto _ : state) {
+        transformer.transformToBatch3D(points, out, OutputUnits::Meters);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_TransformBatch3D)->Arg(8)->Arg(32)->Arg(64)->Arg(128)->Arg(256);
+
+static void BM_TransformBatchInverse(benchmark::State& state) {
+    FloorplanTransformer transformer(makeRotatedConfig());
+    const Eigen::Index n = state.range(0);
+
+    Eigen::Matrix2Xd points(2, n);
+    for (Eigen::Index i = 0; i < n; ++i) {
+        points(0, i) = 0.1 * static_cast<double>(i);
+        points(1, i) = 0.2 * static_cast<double>(i);
+    }
+    Eigen::Matrix2Xd out(2, n);
+
+    for (auto _ : state) {
+        transformer.transformToUWBBatch(points, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_TransformBatchInverse)->Arg(64)->Arg(256);
+
+// --- Concurrency ----------------------------------------------------------
+
+// Readers only: measures scaling of the snapshot load across threads
+// (the case that used to contend on the shared_mutex cacheline)
+static void BM_TransformConcurrentReaders(benchmark::State& state) {
+    static FloorplanTransformer transformer(makeRotatedConfig());
+    double x = 4396.0 + state.thread_index(), y = 17537.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(transformer.transformToPixel(x, y));
+        x += 0.001;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TransformConcurrentReaders)->Threads(1)->Threads(2)->Threads(4)->Threads(8);
+
+// Writer + readers: thread 0 hammers updateConfig() while the rest transform,
+// modeling Firestore calibration edits landing during live traffic
+static void BM_TransformWithConfigUpdates(benchmark::State& state) {
+    static FloorplanTransformer transformer(makeRotatedConfig());
+    if (state.thread_index() == 0) {
+        TransformConfig config = makeRotatedConfig();
+        for (auto _ : state) {
+            config.rotation_rad += 0.0001;
+            transformer.updateConfig(config);
+        }
+    } else {
+        double x = 4396.0 + state.thread_index(), y = 17537.0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(transformer.transformToPixel(x, y));
+            x += 0.001;
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+BENCHMARK(BM_TransformWithConfigUpdates)->Threads(2)->Threads(4)->Threads(8);
+
+// --- Config updates -------------------------------------------------------
+
+static void BM_UpdateConfig(benchmark::State& state) {
+    FloorplanTransformer transformer(makeRotatedConfig());
+    TransformConfig config = makeRotatedConfig();
+    for (auto _ : state) {
+        config.origin_x += 1.0;
+        transformer.updateConfig(config);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UpdateConfig);
+
+BENCHMARK_MAIN();
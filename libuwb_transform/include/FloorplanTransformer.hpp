@@ -3,13 +3,13 @@
 
 #include <Eigen/Dense>
 #include <string>
-#include <shared_mutex>
+#include <memory>
 
 namespace uwb_transform {
 
 /**
  * @brief Configuration structure for FloorplanTransformer
- * 
+ *
  * This structure holds all parameters needed to configure the coordinate
  * transformation between UWB global frame and floorplan pixel frame.
  */
@@ -20,26 +20,80 @@ struct TransformConfig {
     double rotation_rad;  ///< Rotation of UWB frame in radians (counter-clockwise)
     bool x_flipped;       ///< True if UWB X axis opposes Image X axis
     bool y_flipped;       ///< True if UWB Y axis opposes Image Y axis
+    double z_offset;      ///< Floor height offset added to Z in the UWB frame (mm)
+    double z_scale;       ///< Extra Z scale applied on top of the unit conversion
 
     TransformConfig()
-        : origin_x(0.0), origin_y(0.0), scale(1.0), 
-          rotation_rad(0.0), x_flipped(false), y_flipped(false) {}
-    
-    TransformConfig(double ox, double oy, double s, double r, bool xf, bool yf)
-        : origin_x(ox), origin_y(oy), scale(s), 
-          rotation_rad(r), x_flipped(xf), y_flipped(yf) {}
+        : origin_x(0.0), origin_y(0.0), scale(1.0),
+          rotation_rad(0.0), x_flipped(false), y_flipped(false),
+          z_offset(0.0), z_scale(1.0) {}
+
+    TransformConfig(double ox, double oy, double s, double r, bool xf, bool yf,
+                    double zo = 0.0, double zs = 1.0)
+        : origin_x(ox), origin_y(oy), scale(s),
+          rotation_rad(r), x_flipped(xf), y_flipped(yf),
+          z_offset(zo), z_scale(zs) {}
+};
+
+/**
+ * @brief Output unit selection for transformed coordinates
+ *
+ * Values double as indices into the per-unit matrix arrays in
+ * TransformSnapshot, so unit selection on the hot path is an array
+ * index instead of a string comparison.
+ */
+enum class OutputUnits : int {
+    Pixels = 0,       ///< Floorplan pixels
+    Millimeters = 1,  ///< Millimeters (pixels / scale)
+    Meters = 2        ///< Meters (pixels / scale / 1000)
+};
+
+/// Number of supported output units (array size for per-unit matrices)
+constexpr int kOutputUnitCount = 3;
+
+/**
+ * @brief Immutable snapshot of a transformer configuration and its derived matrices
+ *
+ * Config, forward matrix and inverse matrix are always published together as
+ * one snapshot, so readers can never observe a half-updated state. Snapshots
+ * are shared read-only between threads and never modified after construction.
+ *
+ * Besides the base pixel-space matrices, the snapshot precomputes one
+ * complete forward and inverse matrix per output unit with the scale and
+ * mm-to-meters factors folded in, so a transform to any unit is exactly one
+ * matrix-vector product with no divisions.
+ *
+ * The snapshot also classifies the config at build time: with
+ * rotation_rad == 0 every precomputed matrix is axis-aligned (the
+ * off-diagonal entries are exactly zero - axis flips only negate the
+ * diagonal), so the transform paths dispatch to a two-FMA scalar kernel
+ * instead of the general 3x3 product. Most deployed floorplans fall in
+ * this class.
+ */
+struct TransformSnapshot {
+    TransformConfig config;            ///< Configuration this snapshot was built from
+    Eigen::Matrix3d transform_matrix;  ///< Forward transformation matrix (UWB mm -> pixels)
+    Eigen::Matrix3d inverse_matrix;    ///< Cached inverse matrix (pixels -> UWB mm)
+    Eigen::Matrix3d unit_matrix[kOutputUnitCount];   ///< UWB mm -> {pixels, mm, meters}
+    Eigen::Matrix3d unit_inverse[kOutputUnitCount];  ///< {pixels, mm, meters} -> UWB mm
+    Eigen::Matrix4d unit_matrix3d[kOutputUnitCount]; ///< 4x4 homogeneous UWB mm (x,y,z) -> unit
+    bool axis_aligned;                 ///< True if rotation is zero (scale+flip+translate only)
 };
 
 /**
  * @brief High-performance coordinate transformer for UWB-to-Floorplan mapping
- * 
+ *
  * This class implements a 3x3 homogeneous transformation matrix that converts
  * between UWB global coordinates and floorplan pixel coordinates. The transformation
  * pipeline is: Translation -> Rotation -> Scale (with optional axis flipping).
- * 
+ *
  * Uses Eigen library for optimized matrix operations with SIMD support.
- * 
- * @note Thread-safe for read operations after construction
+ *
+ * Thread safety: the configuration and matrices live in an immutable snapshot
+ * published through an atomic shared_ptr. Transform calls do a single atomic
+ * load and no locking, so concurrent readers never contend with each other.
+ * updateConfig() builds a fresh snapshot and atomically swaps it in; in-flight
+ * transforms keep using the snapshot they already loaded.
  */
 class FloorplanTransformer {
 public:
@@ -59,11 +113,11 @@ public:
 
     /**
      * @brief Transform UWB coordinates to floorplan coordinates in meters
-     * 
+     *
      * Applies the full transformation matrix to convert from UWB global frame (mm)
      * to floorplan coordinates in meters. This matches the Python implementation
      * which outputs meters for display/plotting purposes.
-     * 
+     *
      * @param uwb_x X coordinate in UWB frame (mm)
      * @param uwb_y Y coordinate in UWB frame (mm)
      * @return Eigen::Vector2d Floorplan coordinates (x, y) in meters
@@ -72,61 +126,169 @@ public:
 
     /**
      * @brief Transform floorplan coordinates (meters) back to UWB coordinates
-     * 
+     *
      * Applies the inverse transformation matrix to convert from floorplan
      * coordinates (in meters) back to UWB global frame (in mm).
-     * 
+     *
      * @param meter_x X coordinate in meters
      * @param meter_y Y coordinate in meters
      * @return Eigen::Vector2d UWB coordinates (x, y) in mm
      */
     Eigen::Vector2d transformToUWB(double meter_x, double meter_y) const;
 
+    /**
+     * @brief Transform UWB coordinates to floorplan coordinates in the given unit
+     *
+     * Uses the precomputed per-unit matrix, so the cost is one matrix-vector
+     * product regardless of the selected unit - no divisions, no string
+     * comparisons.
+     *
+     * @param uwb_x X coordinate in UWB frame (mm)
+     * @param uwb_y Y coordinate in UWB frame (mm)
+     * @param units Desired output unit
+     * @return Eigen::Vector2d Floorplan coordinates (x, y) in the requested unit
+     */
+    Eigen::Vector2d transformTo(double uwb_x, double uwb_y, OutputUnits units) const;
+
+    /**
+     * @brief Transform floorplan coordinates in the given unit back to UWB coordinates
+     *
+     * Inverse counterpart of transformTo(), using the precomputed per-unit
+     * inverse matrix.
+     *
+     * @param x X coordinate in the given unit
+     * @param y Y coordinate in the given unit
+     * @param units Unit of the input coordinates
+     * @return Eigen::Vector2d UWB coordinates (x, y) in mm
+     */
+    Eigen::Vector2d transformFrom(double x, double y, OutputUnits units) const;
+
+    /**
+     * @brief Transform a batch of UWB coordinates to floorplan coordinates in meters
+     *
+     * Batch variant of transformToPixel(). The configuration snapshot is loaded
+     * once for the whole batch and the transformation is applied as a single
+     * matrix product, allowing Eigen to vectorize across all points. Results
+     * are written into the caller-provided output matrix (resized if needed),
+     * so no per-point allocations occur.
+     *
+     * @param uwb_points 2xN matrix of UWB coordinates, one point per column (mm)
+     * @param meter_points Output: 2xN matrix of floorplan coordinates (meters)
+     */
+    void transformToPixelBatch(const Eigen::Matrix2Xd& uwb_points,
+                               Eigen::Matrix2Xd& meter_points) const;
+
+    /**
+     * @brief Transform a batch of floorplan coordinates (meters) back to UWB coordinates
+     *
+     * Batch variant of transformToUWB(). See transformToPixelBatch() for the
+     * snapshot and allocation behavior.
+     *
+     * @param meter_points 2xN matrix of floorplan coordinates, one point per column (meters)
+     * @param uwb_points Output: 2xN matrix of UWB coordinates (mm)
+     */
+    void transformToUWBBatch(const Eigen::Matrix2Xd& meter_points,
+                             Eigen::Matrix2Xd& uwb_points) const;
+
+    /**
+     * @brief Batch variant of transformTo() for an arbitrary output unit
+     *
+     * @param uwb_points 2xN matrix of UWB coordinates, one point per column (mm)
+     * @param out Output: 2xN matrix of floorplan coordinates in the requested unit
+     * @param units Desired output unit
+     */
+    void transformToBatch(const Eigen::Matrix2Xd& uwb_points,
+                          Eigen::Matrix2Xd& out, OutputUnits units) const;
+
+    /**
+     * @brief Transform a full 3D UWB point to floorplan coordinates
+     *
+     * Uses the precomputed per-unit 4x4 homogeneous matrix, so X, Y and Z
+     * go through one matrix-vector product: Z gets the same unit conversion
+     * as X/Y (mm in; pixels multiply by scale, meters divide by 1000),
+     * scaled by z_scale and shifted by the z_offset floor height - no
+     * caller-side per-point unit branching.
+     *
+     * @param uwb_x X coordinate in UWB frame (mm)
+     * @param uwb_y Y coordinate in UWB frame (mm)
+     * @param uwb_z Z coordinate in UWB frame (mm)
+     * @param units Desired output unit
+     * @return Eigen::Vector3d Floorplan coordinates (x, y, z) in the requested unit
+     */
+    Eigen::Vector3d transformTo3D(double uwb_x, double uwb_y, double uwb_z,
+                                  OutputUnits units) const;
+
+    /**
+     * @brief Batch variant of transformTo3D()
+     *
+     * One affine 3xN pass over the whole batch (snapshot loaded once), so
+     * Eigen vectorizes across all three coordinate rows together.
+     *
+     * @param uwb_points 3xN matrix of UWB coordinates, one point per column (mm)
+     * @param out Output: 3xN matrix of floorplan coordinates in the requested unit
+     * @param units Desired output unit
+     */
+    void transformToBatch3D(const Eigen::Matrix3Xd& uwb_points,
+                            Eigen::Matrix3Xd& out, OutputUnits units) const;
+
     /**
      * @brief Get the forward transformation matrix
-     * @return const Eigen::Matrix3d& The 3x3 transformation matrix
+     * @return Eigen::Matrix3d Copy of the 3x3 transformation matrix
      */
-    const Eigen::Matrix3d& getMatrix() const { return transform_matrix_; }
+    Eigen::Matrix3d getMatrix() const { return getSnapshot()->transform_matrix; }
 
     /**
      * @brief Get the inverse transformation matrix
-     * @return const Eigen::Matrix3d& The 3x3 inverse transformation matrix
+     * @return Eigen::Matrix3d Copy of the 3x3 inverse transformation matrix
      */
-    const Eigen::Matrix3d& getInverseMatrix() const { return inverse_matrix_; }
+    Eigen::Matrix3d getInverseMatrix() const { return getSnapshot()->inverse_matrix; }
 
     /**
      * @brief Get the current configuration
-     * @return const TransformConfig& The configuration used by this transformer
+     * @return TransformConfig Copy of the configuration used by this transformer
+     */
+    TransformConfig getConfig() const { return getSnapshot()->config; }
+
+    /**
+     * @brief Get the current configuration snapshot
+     *
+     * Single atomic load of the published snapshot. Callers doing several
+     * operations against one consistent config should load the snapshot once
+     * and reuse it rather than calling the individual getters repeatedly.
+     *
+     * @return std::shared_ptr<const TransformSnapshot> The current snapshot
      */
-    const TransformConfig& getConfig() const { return config_; }
+    std::shared_ptr<const TransformSnapshot> getSnapshot() const;
 
     /**
      * @brief Update configuration at runtime (thread-safe)
-     * 
+     *
      * This method allows updating the transformation configuration while
-     * the transformer is actively being used by multiple threads. It uses
-     * exclusive locking to ensure safe updates.
-     * 
+     * the transformer is actively being used by multiple threads. It builds
+     * a new immutable snapshot and atomically publishes it, so readers are
+     * never blocked.
+     *
      * @param config New configuration to apply
      */
     void updateConfig(const TransformConfig& config);
 
 private:
     /**
-     * @brief Calculate the transformation matrix from configuration
+     * @brief Calculate the transformation matrix from a configuration
+     * @param config Configuration to build the matrix from
      * @return Eigen::Matrix3d The combined transformation matrix
      */
-    Eigen::Matrix3d calculateTransformMatrix() const;
+    static Eigen::Matrix3d calculateTransformMatrix(const TransformConfig& config);
 
     /**
-     * @brief Recalculate transformation matrices from current config (not thread-safe, caller must lock)
+     * @brief Build a complete snapshot (config + forward + inverse matrices)
+     * @param config Configuration to build the snapshot from
+     * @return std::shared_ptr<const TransformSnapshot> New immutable snapshot
      */
-    void recomputeMatrices();
+    static std::shared_ptr<const TransformSnapshot> makeSnapshot(const TransformConfig& config);
 
-    TransformConfig config_;                     ///< Stored configuration
-    Eigen::Matrix3d transform_matrix_;           ///< Forward transformation matrix
-    Eigen::Matrix3d inverse_matrix_;             ///< Cached inverse matrix
-    mutable std::shared_mutex config_mutex_;     ///< Mutex for thread-safe config updates
+    /// Current snapshot, accessed via std::atomic_load/atomic_store
+    std::shared_ptr<const TransformSnapshot> snapshot_;
 };
 
 } // namespace uwb_transform
@@ -3,17 +3,14 @@
 #include <fstream>
 #include <stdexcept>
 #include <cmath>
-#include <mutex>
-#include <shared_mutex>
+#include <atomic>
 
 using json = nlohmann::json;
 
 namespace uwb_transform {
 
 FloorplanTransformer::FloorplanTransformer(const TransformConfig& config)
-    : config_(config) {
-    transform_matrix_ = calculateTransformMatrix();
-    inverse_matrix_ = transform_matrix_.inverse();
+    : snapshot_(makeSnapshot(config)) {
 }
 
 FloorplanTransformer FloorplanTransformer::fromConfigFile(const std::string& config_path) {
@@ -30,9 +27,9 @@ FloorplanTransformer FloorplanTransformer::fromConfigFile(const std::string& con
     }
 
     TransformConfig config;
-    
+
     // Load required parameters
-    if (!j.contains("origin_x") || !j.contains("origin_y") || 
+    if (!j.contains("origin_x") || !j.contains("origin_y") ||
         !j.contains("scale") || !j.contains("rotation_rad")) {
         throw std::runtime_error("Missing required configuration parameters");
     }
@@ -41,28 +38,30 @@ FloorplanTransformer FloorplanTransformer::fromConfigFile(const std::string& con
     config.origin_y = j["origin_y"].get<double>();
     config.scale = j["scale"].get<double>();
     config.rotation_rad = j["rotation_rad"].get<double>();
-    
+
     // Optional parameters with defaults
     config.x_flipped = j.value("x_flipped", false);
     config.y_flipped = j.value("y_flipped", false);
+    config.z_offset = j.value("z_offset", 0.0);
+    config.z_scale = j.value("z_scale", 1.0);
 
     return FloorplanTransformer(config);
 }
 
-Eigen::Matrix3d FloorplanTransformer::calculateTransformMatrix() const {
+Eigen::Matrix3d FloorplanTransformer::calculateTransformMatrix(const TransformConfig& config) {
     // --- 1. Translation Matrix (T) ---
     // Shifts points so the Image Origin becomes (0,0)
     Eigen::Matrix3d T = Eigen::Matrix3d::Identity();
-    T(0, 2) = -config_.origin_x;
-    T(1, 2) = -config_.origin_y;
+    T(0, 2) = -config.origin_x;
+    T(1, 2) = -config.origin_y;
 
     // --- 2. Rotation Matrix (R) ---
     // Rotates the axes to align UWB with Image
     // Note: For pozyx we have to negate the rotation. IDK why (might change if we switch to other RTLS)
-    double theta = -config_.rotation_rad;
+    double theta = -config.rotation_rad;
     double c = std::cos(theta);
     double s = std::sin(theta);
-    
+
     Eigen::Matrix3d R = Eigen::Matrix3d::Identity();
     R(0, 0) = c;
     R(0, 1) = -s;
@@ -71,9 +70,9 @@ Eigen::Matrix3d FloorplanTransformer::calculateTransformMatrix() const {
 
     // --- 3. Scale Matrix (S) ---
     // Handles Scaling (px/unit) and Axis Flipping
-    double scale_x = config_.scale * (config_.x_flipped ? -1.0 : 1.0);
-    double scale_y = config_.scale * (config_.y_flipped ? -1.0 : 1.0);
-    
+    double scale_x = config.scale * (config.x_flipped ? -1.0 : 1.0);
+    double scale_y = config.scale * (config.y_flipped ? -1.0 : 1.0);
+
     Eigen::Matrix3d S = Eigen::Matrix3d::Identity();
     S(0, 0) = scale_x;
     S(1, 1) = scale_y;
@@ -83,55 +82,219 @@ Eigen::Matrix3d FloorplanTransformer::calculateTransformMatrix() const {
     return S * R * T;
 }
 
+std::shared_ptr<const TransformSnapshot> FloorplanTransformer::makeSnapshot(
+    const TransformConfig& config) {
+    auto snapshot = std::make_shared<TransformSnapshot>();
+    snapshot->config = config;
+    snapshot->transform_matrix = calculateTransformMatrix(config);
+    snapshot->inverse_matrix = snapshot->transform_matrix.inverse();
+
+    // Precompute one complete matrix per output unit with the unit conversion
+    // folded in, so the hot path never divides by scale or 1000 per point.
+    // Pixels is the base matrix; mm divides out the scale; meters additionally
+    // divides by 1000.
+    const double unit_factors[kOutputUnitCount] = {
+        1.0,                            // Pixels
+        1.0 / config.scale,             // Millimeters
+        1.0 / (config.scale * 1000.0)   // Meters
+    };
+    // Z passes straight through the planar transform (no rotation or flip in
+    // the Z axis for a floorplan), so its per-unit factor is just the unit
+    // conversion from mm: pixels multiply by scale, meters divide by 1000.
+    const double z_factors[kOutputUnitCount] = {
+        config.scale,                   // Pixels
+        1.0,                            // Millimeters
+        1.0 / 1000.0                    // Meters
+    };
+    for (int u = 0; u < kOutputUnitCount; ++u) {
+        Eigen::Matrix3d D = Eigen::Matrix3d::Identity();
+        D(0, 0) = unit_factors[u];
+        D(1, 1) = unit_factors[u];
+        snapshot->unit_matrix[u] = D * snapshot->transform_matrix;
+        snapshot->unit_inverse[u] = snapshot->unit_matrix[u].inverse();
+
+        // 4x4 homogeneous matrix for full 3D points: X/Y rows are lifted from
+        // the planar per-unit matrix; the Z row applies z_scale, the floor
+        // height offset (mm, converted with the same factor) and the unit
+        // conversion in one precomputed fused row.
+        Eigen::Matrix4d M3 = Eigen::Matrix4d::Identity();
+        M3.topLeftCorner<2, 2>() = snapshot->unit_matrix[u].topLeftCorner<2, 2>();
+        M3.topRightCorner<2, 1>() = snapshot->unit_matrix[u].topRightCorner<2, 1>();
+        M3(2, 2) = z_factors[u] * config.z_scale;
+        M3(2, 3) = z_factors[u] * config.z_offset;
+        snapshot->unit_matrix3d[u] = M3;
+    }
+
+    // Kernel classification: with zero rotation the off-diagonal entries of
+    // every precomputed matrix are exactly zero (flips only negate the
+    // diagonal), so transforms reduce to x' = M(0,0)*x + M(0,2) and
+    // y' = M(1,1)*y + M(1,2). Classified once here, never re-checked per point.
+    snapshot->axis_aligned = (config.rotation_rad == 0.0);
+
+    return snapshot;
+}
+
+std::shared_ptr<const TransformSnapshot> FloorplanTransformer::getSnapshot() const {
+    // Single atomic load - no lock traffic on the read path
+    return std::atomic_load_explicit(&snapshot_, std::memory_order_acquire);
+}
+
 Eigen::Vector2d FloorplanTransformer::transformToPixel(double uwb_x, double uwb_y) const {
-    // Acquire shared lock for reading (allows multiple concurrent readers)
-    std::shared_lock<std::shared_mutex> lock(config_mutex_);
-    
-    // Create homogeneous coordinate vector
-    Eigen::Vector3d uwb_point(uwb_x, uwb_y, 1.0);
-    
-    // Apply transformation
-    Eigen::Vector3d pixel_point = transform_matrix_ * uwb_point;
-    
-    // Convert to meters: res[0], res[1] is in pixels
-    // Divide by scale to get it in mm, then by 1000 to get meters
-    double meter_x = (pixel_point(0) / config_.scale) / 1000.0;
-    double meter_y = (pixel_point(1) / config_.scale) / 1000.0;
-    
-    return Eigen::Vector2d(meter_x, meter_y);
+    // Historical name: output is meters (matches the Python implementation)
+    return transformTo(uwb_x, uwb_y, OutputUnits::Meters);
 }
 
 Eigen::Vector2d FloorplanTransformer::transformToUWB(double meter_x, double meter_y) const {
-    // Acquire shared lock for reading (allows multiple concurrent readers)
-    std::shared_lock<std::shared_mutex> lock(config_mutex_);
-    
-    // Convert meters to pixels for reverse transform
-    // meters * 1000 = mm, mm * scale = pixels
-    double pixel_x = meter_x * 1000.0 * config_.scale;
-    double pixel_y = meter_y * 1000.0 * config_.scale;
-    
-    // Create homogeneous coordinate vector
-    Eigen::Vector3d pixel_point(pixel_x, pixel_y, 1.0);
-    
-    // Apply inverse transformation
-    Eigen::Vector3d uwb_point = inverse_matrix_ * pixel_point;
-    
+    return transformFrom(meter_x, meter_y, OutputUnits::Meters);
+}
+
+Eigen::Vector2d FloorplanTransformer::transformTo(double uwb_x, double uwb_y,
+                                                  OutputUnits units) const {
+    // Load the current immutable snapshot (one atomic load, no locking)
+    auto snap = getSnapshot();
+
+    const Eigen::Matrix3d& M = snap->unit_matrix[static_cast<int>(units)];
+
+    // Axis-aligned fast path: two fused multiply-adds instead of the full
+    // 3x3 product (off-diagonals are exactly zero, see makeSnapshot())
+    if (snap->axis_aligned) {
+        return Eigen::Vector2d(M(0, 0) * uwb_x + M(0, 2),
+                               M(1, 1) * uwb_y + M(1, 2));
+    }
+
+    // General case: single matrix-vector product against the precomputed
+    // per-unit matrix; the unit conversion factors are already folded in
+    Eigen::Vector3d result = M * Eigen::Vector3d(uwb_x, uwb_y, 1.0);
+
+    return Eigen::Vector2d(result(0), result(1));
+}
+
+Eigen::Vector2d FloorplanTransformer::transformFrom(double x, double y,
+                                                    OutputUnits units) const {
+    // Load the current immutable snapshot (one atomic load, no locking)
+    auto snap = getSnapshot();
+
+    const Eigen::Matrix3d& M = snap->unit_inverse[static_cast<int>(units)];
+
+    // The inverse of an axis-aligned matrix is axis-aligned, so the same
+    // two-FMA kernel applies on the way back
+    if (snap->axis_aligned) {
+        return Eigen::Vector2d(M(0, 0) * x + M(0, 2),
+                               M(1, 1) * y + M(1, 2));
+    }
+
+    // General case: single matrix-vector product against the precomputed
+    // per-unit inverse
+    Eigen::Vector3d uwb_point = M * Eigen::Vector3d(x, y, 1.0);
+
     // Return UWB coordinates (x, y) in mm
     return Eigen::Vector2d(uwb_point(0), uwb_point(1));
 }
 
-void FloorplanTransformer::updateConfig(const TransformConfig& config) {
-    // Acquire exclusive lock for writing (blocks all readers and writers)
-    std::unique_lock<std::shared_mutex> lock(config_mutex_);
-    
-    config_ = config;
-    recomputeMatrices();
+Eigen::Vector3d FloorplanTransformer::transformTo3D(double uwb_x, double uwb_y,
+                                                    double uwb_z,
+                                                    OutputUnits units) const {
+    // Load the current immutable snapshot (one atomic load, no locking)
+    auto snap = getSnapshot();
+
+    const Eigen::Matrix4d& M = snap->unit_matrix3d[static_cast<int>(units)];
+
+    // Axis-aligned fast path: three fused multiply-adds (Z is always
+    // axis-aligned; with zero rotation X and Y are too)
+    if (snap->axis_aligned) {
+        return Eigen::Vector3d(M(0, 0) * uwb_x + M(0, 3),
+                               M(1, 1) * uwb_y + M(1, 3),
+                               M(2, 2) * uwb_z + M(2, 3));
+    }
+
+    // General case: single matrix-vector product against the precomputed
+    // 4x4 matrix; unit conversion, z_scale and z_offset are all folded in
+    Eigen::Vector4d result = M * Eigen::Vector4d(uwb_x, uwb_y, uwb_z, 1.0);
+
+    return result.head<3>();
+}
+
+void FloorplanTransformer::transformToPixelBatch(const Eigen::Matrix2Xd& uwb_points,
+                                                 Eigen::Matrix2Xd& meter_points) const {
+    transformToBatch(uwb_points, meter_points, OutputUnits::Meters);
+}
+
+void FloorplanTransformer::transformToBatch(const Eigen::Matrix2Xd& uwb_points,
+                                            Eigen::Matrix2Xd& out,
+                                            OutputUnits units) const {
+    // Load the snapshot once for the whole batch
+    auto snap = getSnapshot();
+    const Eigen::Matrix3d& M = snap->unit_matrix[static_cast<int>(units)];
+
+    const Eigen::Index n = uwb_points.cols();
+    out.resize(2, n);
+
+    // Axis-aligned fast path: per-row scale-and-offset, which Eigen turns
+    // into straight-line FMA loops with no cross-row data dependency
+    if (snap->axis_aligned) {
+        out.row(0).array() = M(0, 0) * uwb_points.row(0).array() + M(0, 2);
+        out.row(1).array() = M(1, 1) * uwb_points.row(1).array() + M(1, 2);
+        return;
+    }
+
+    // Apply the affine part of the homogeneous transform as a single 2xN product:
+    // out = A * uwb + t, where A is the top-left 2x2 block and t the translation
+    // column; the unit conversion is already folded into M
+    out.noalias() = M.topLeftCorner<2, 2>() * uwb_points;
+    out.colwise() += M.topRightCorner<2, 1>();
 }
 
-void FloorplanTransformer::recomputeMatrices() {
-    // This method assumes the caller already holds a lock
-    transform_matrix_ = calculateTransformMatrix();
-    inverse_matrix_ = transform_matrix_.inverse();
+void FloorplanTransformer::transformToBatch3D(const Eigen::Matrix3Xd& uwb_points,
+                                              Eigen::Matrix3Xd& out,
+                                              OutputUnits units) const {
+    // Load the snapshot once for the whole batch
+    auto snap = getSnapshot();
+    const Eigen::Matrix4d& M = snap->unit_matrix3d[static_cast<int>(units)];
+
+    const Eigen::Index n = uwb_points.cols();
+    out.resize(3, n);
+
+    // Axis-aligned fast path: per-row scale-and-offset across all three
+    // coordinate rows, vectorized with no cross-row data dependency
+    if (snap->axis_aligned) {
+        out.row(0).array() = M(0, 0) * uwb_points.row(0).array() + M(0, 3);
+        out.row(1).array() = M(1, 1) * uwb_points.row(1).array() + M(1, 3);
+        out.row(2).array() = M(2, 2) * uwb_points.row(2).array() + M(2, 3);
+        return;
+    }
+
+    // Single affine 3xN pass: out = A * uwb + t with the top-left 3x3 block
+    // and translation column of the precomputed homogeneous matrix
+    out.noalias() = M.topLeftCorner<3, 3>() * uwb_points;
+    out.colwise() += M.topRightCorner<3, 1>();
+}
+
+void FloorplanTransformer::transformToUWBBatch(const Eigen::Matrix2Xd& meter_points,
+                                               Eigen::Matrix2Xd& uwb_points) const {
+    // Load the snapshot once for the whole batch
+    auto snap = getSnapshot();
+    const Eigen::Matrix3d& M = snap->unit_inverse[static_cast<int>(OutputUnits::Meters)];
+
+    const Eigen::Index n = meter_points.cols();
+    uwb_points.resize(2, n);
+
+    // Same axis-aligned kernel as transformToBatch(), on the inverse matrix
+    if (snap->axis_aligned) {
+        uwb_points.row(0).array() = M(0, 0) * meter_points.row(0).array() + M(0, 2);
+        uwb_points.row(1).array() = M(1, 1) * meter_points.row(1).array() + M(1, 2);
+        return;
+    }
+
+    // Single affine pass with the meters-to-UWB conversion folded into M
+    uwb_points.noalias() = M.topLeftCorner<2, 2>() * meter_points;
+    uwb_points.colwise() += M.topRightCorner<2, 1>();
+}
+
+void FloorplanTransformer::updateConfig(const TransformConfig& config) {
+    // Build a fresh snapshot and atomically publish it. Readers holding the
+    // old snapshot keep using it; new calls pick up the new one immediately.
+    std::atomic_store_explicit(&snapshot_, makeSnapshot(config),
+                               std::memory_order_release);
 }
 
 } // namespace uwb_transform
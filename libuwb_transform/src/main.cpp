@@ -3,11 +3,126 @@
 #include <iomanip>
 #include <cmath>
 #include <chrono>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 using namespace uwb_transform;
 
+// Run `thread_count` concurrent transform loops against one shared
+// transformer for `seconds` and return the aggregate throughput
+// (transforms/second). This is the contention shape of production: worker
+// threads hammering transformToPixel() on a single FloorplanTransformer.
+double runScalingPass(const FloorplanTransformer& transformer,
+                      int thread_count, int seconds,
+                      std::vector<double>& per_thread_rates) {
+    std::atomic<bool> stop{false};
+    std::vector<uint64_t> counts(thread_count, 0);
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count);
+
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&transformer, &stop, &counts, t]() {
+            double x = 4396.0 + t, y = 17537.0 - t;
+            double sink = 0.0;  // Consumes results so the loop can't be elided
+            uint64_t n = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                // Small inner batch so the stop-flag check stays off the
+                // per-transform critical path
+                for (int i = 0; i < 1024; ++i) {
+                    sink += transformer.transformToPixel(x, y)(0);
+                    x += 0.001;
+                }
+                n += 1024;
+            }
+            volatile double keep = sink;
+            (void)keep;
+            counts[t] = n;
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& th : threads) {
+        th.join();
+    }
+    double elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    per_thread_rates.clear();
+    double aggregate = 0.0;
+    for (uint64_t n : counts) {
+        per_thread_rates.push_back(static_cast<double>(n) / elapsed);
+        aggregate += per_thread_rates.back();
+    }
+    return aggregate;
+}
+
+// Multi-threaded scaling benchmark (--threads N --seconds S [--update-hz R]):
+// measures a single-threaded baseline, then N concurrent readers (optionally
+// with a background updateConfig() writer), and reports per-thread and
+// aggregate throughput plus scaling efficiency versus the baseline. This is
+// the regression gate for any change to how readers obtain the snapshot.
+int runScalingBenchmark(const FloorplanTransformer& transformer,
+                        FloorplanTransformer& writable,
+                        int thread_count, int seconds, double update_hz) {
+    std::cout << "\n=================================================\n";
+    std::cout << "  Multi-threaded Scaling Benchmark\n";
+    std::cout << "=================================================\n";
+    std::cout << "\nThreads: " << thread_count
+              << ", duration per pass: " << seconds << " s";
+    if (update_hz > 0.0) {
+        std::cout << ", config updates: " << update_hz << " Hz";
+    }
+    std::cout << "\n";
+
+    // Optional background writer: republishes the config at the requested
+    // rate, the same pattern as a live Firestore calibration stream
+    std::atomic<bool> update_stop{false};
+    std::thread updater;
+    if (update_hz > 0.0) {
+        updater = std::thread([&writable, &update_stop, update_hz]() {
+            const auto interval = std::chrono::duration<double>(1.0 / update_hz);
+            TransformConfig config = writable.getConfig();
+            while (!update_stop.load(std::memory_order_relaxed)) {
+                writable.updateConfig(config);
+                std::this_thread::sleep_for(interval);
+            }
+        });
+    }
+
+    std::vector<double> rates;
+    std::cout << "\nBaseline (1 thread)...\n";
+    double baseline = runScalingPass(transformer, 1, seconds, rates);
+    std::cout << "  " << std::fixed << std::setprecision(0)
+              << baseline << " transforms/s\n";
+
+    std::cout << "\nScaling pass (" << thread_count << " threads)...\n";
+    double aggregate = runScalingPass(transformer, thread_count, seconds, rates);
+
+    if (updater.joinable()) {
+        update_stop.store(true, std::memory_order_relaxed);
+        updater.join();
+    }
+
+    std::cout << "\nPer-thread throughput:\n";
+    for (size_t t = 0; t < rates.size(); ++t) {
+        std::cout << "  Thread " << t << ": " << std::fixed
+                  << std::setprecision(0) << rates[t] << " transforms/s\n";
+    }
+    double efficiency = aggregate / (baseline * thread_count);
+    std::cout << "\nAggregate:          " << std::fixed << std::setprecision(0)
+              << aggregate << " transforms/s\n";
+    std::cout << "Speedup:            " << std::setprecision(2)
+              << (aggregate / baseline) << "x over 1 thread\n";
+    std::cout << "Scaling efficiency: " << std::setprecision(1)
+              << (efficiency * 100.0) << "% of linear\n\n";
+    return 0;
+}
+
 // Helper function to print test results
-void printTestResult(const std::string& test_name, 
+void printTestResult(const std::string& test_name,
                      const Eigen::Vector2d& result,
                      const Eigen::Vector2d& expected,
                      double tolerance = 0.01) {
@@ -28,10 +143,30 @@ int main(int argc, char** argv) {
         std::cout << "  UWB-to-Floorplan Coordinate Transformer Test\n";
         std::cout << "=================================================\n";
 
-        // Determine config file path
+        // Determine config file path and scaling-benchmark options. Flags:
+        //   --threads N    run the multi-threaded scaling benchmark with N threads
+        //   --seconds S    duration of each benchmark pass (default 5)
+        //   --update-hz R  background updateConfig() rate during the pass
+        // A bare argument is the config file path, as before.
         std::string config_path = "config/transform_config.json";
-        if (argc > 1) {
-            config_path = argv[1];
+        int bench_threads = 0;
+        int bench_seconds = 5;
+        double bench_update_hz = 0.0;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--threads" && i + 1 < argc) {
+                bench_threads = std::stoi(argv[++i]);
+            } else if (arg == "--seconds" && i + 1 < argc) {
+                bench_seconds = std::stoi(argv[++i]);
+            } else if (arg == "--update-hz" && i + 1 < argc) {
+                bench_update_hz = std::stod(argv[++i]);
+            } else {
+                config_path = arg;
+            }
+        }
+        if (bench_threads < 0 || bench_seconds < 1) {
+            std::cerr << "\nERROR: --threads must be >= 1 and --seconds >= 1\n\n";
+            return 1;
         }
 
         std::cout << "\nLoading configuration from: " << config_path << "\n";
@@ -49,6 +184,13 @@ int main(int argc, char** argv) {
         std::cout << "  X Flipped:     " << (config.x_flipped ? "Yes" : "No") << "\n";
         std::cout << "  Y Flipped:     " << (config.y_flipped ? "Yes" : "No") << "\n";
 
+        // Scaling-benchmark mode replaces the test suite entirely
+        if (bench_threads > 0) {
+            return runScalingBenchmark(transformer, transformer,
+                                       bench_threads, bench_seconds,
+                                       bench_update_hz);
+        }
+
         std::cout << "\n=================================================\n";
         std::cout << "  Test 1: Forward Transform (UWB -> Pixel)\n";
         std::cout << "=================================================\n";
@@ -1,15 +1,43 @@
 #ifndef BRIDGE_CORE_HPP
 #define BRIDGE_CORE_HPP
 
+#include "CaptureLog.hpp"
+#include "ShmRing.hpp"
+#include "MetricsServer.hpp"
 #include "ConfigLoader.hpp"
 #include "MqttHandler.hpp"
+#include "TopicMatcher.hpp"
 #include "FloorplanTransformer.hpp"
+#include "LatencyHistogram.hpp"
 #include <memory>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <thread>
+#include <vector>
 
 namespace uwb_bridge {
 
+/**
+ * @brief Output wire format for transformed positions
+ *
+ * Json keeps the current behavior (full payload re-serialized as text).
+ * Cbor and MsgPack encode a minimal position document with nlohmann's
+ * binary serializers. CompactBinary is a fixed-field packed struct (see
+ * BridgeCore::createCompactBinaryOutput) for bandwidth-critical links.
+ * Binary formats publish under dest_topic_prefix_binary so payload types
+ * never mix on one topic.
+ */
+enum class OutputFormat {
+    Json,
+    Cbor,
+    MsgPack,
+    CompactBinary
+};
+
 /**
  * @brief Statistics for the bridge operations
  */
@@ -18,18 +46,96 @@ struct BridgeStats {
     uint64_t successful_transforms;
     uint64_t failed_transforms;
     uint64_t malformed_messages;
+    uint64_t dropped_messages;
+    uint64_t conflated_messages;
     double avg_processing_time_us;
+    LatencyHistogram::Snapshot parse_latency;      ///< Payload parse stage (us)
+    LatencyHistogram::Snapshot transform_latency;  ///< Coordinate transform stage (us)
+    LatencyHistogram::Snapshot publish_latency;    ///< Publish-complete stage (us)
     std::chrono::system_clock::time_point start_time;
-    
-    BridgeStats() 
-        : total_messages(0), 
+
+    BridgeStats()
+        : total_messages(0),
           successful_transforms(0),
           failed_transforms(0),
           malformed_messages(0),
+          dropped_messages(0),
+          conflated_messages(0),
           avg_processing_time_us(0.0),
           start_time(std::chrono::system_clock::now()) {}
 };
 
+/**
+ * @brief Work item carried from the MQTT callback to a worker thread
+ */
+struct WorkItem {
+    mqtt::const_message_ptr msg;  ///< Shared Paho message (topic + payload, zero copies)
+    std::string tag_id;           ///< Tag ID extracted from the topic (conflation key)
+    std::chrono::high_resolution_clock::time_point arrival_time;  ///< Broker receive timestamp
+};
+
+/**
+ * @brief Byte spans located by the fast-path scanner for verbatim splicing
+ *
+ * Offsets into the original payload: where the data.coordinates.{x,y,z}
+ * values sit (patched with the transformed numbers), where the coordinates
+ * object closes (insertion point for the stamped frame_id /
+ * processing_timestamp / units fields) and where the data.anchorData member
+ * spans (removed on output). Everything between the patches is copied
+ * from the payload verbatim, so sibling fields survive untouched.
+ */
+struct PozyxSpans {
+    size_t elem_begin = 0;  ///< '{' of the first (or only) element object
+    size_t elem_end = 0;    ///< One past that object's closing '}'
+    size_t x_begin = 0, x_end = 0;  ///< data.coordinates.x value bytes
+    size_t y_begin = 0, y_end = 0;  ///< data.coordinates.y value bytes
+    size_t z_begin = 0, z_end = 0;  ///< data.coordinates.z value bytes (if has_z)
+    bool has_z = false;             ///< True when the payload carried a z value
+    size_t coords_close = 0;        ///< Offset of the coordinates object's '}'
+    size_t anchor_begin = 0, anchor_end = 0;  ///< data.anchorData member (key through value)
+    bool has_anchor = false;        ///< True when anchorData is present
+};
+
+/**
+ * @brief Parsed representation of an incoming message
+ *
+ * Carries the JSON DOM from the parse stage through to output serialization,
+ * so each payload is parsed exactly once: the coordinates are extracted from
+ * the DOM, the transformed values are patched back into the same DOM, and it
+ * is serialized once for publishing.
+ */
+struct ParsedMessage {
+    nlohmann::json doc;   ///< Parsed JSON document (only materialized on the DOM path)
+    double uwb_x = 0.0;   ///< Extracted UWB X coordinate (mm)
+    double uwb_y = 0.0;   ///< Extracted UWB Y coordinate (mm)
+    double uwb_z = 0.0;   ///< Extracted UWB Z coordinate (mm)
+    std::string tag_id;   ///< Tag identifier (empty if absent from payload)
+    bool has_dom = false;       ///< True when doc holds a DOM (generic parse path)
+    bool is_array = false;      ///< True when the payload was array-wrapped (Pozyx style)
+    double timestamp = 0.0;     ///< Top-level payload timestamp (fast path only)
+    bool has_timestamp = false; ///< True when timestamp was present in the payload
+    const std::string* raw = nullptr; ///< Fast path: original payload for splicing
+                                      ///< (points at the Paho message's storage,
+                                      ///< valid for the lifetime of the work item)
+    PozyxSpans spans;           ///< Fast path: byte spans the splice writer patches
+
+    /**
+     * @brief Reset for reuse on the next message
+     *
+     * Clears extracted fields but keeps the tag_id string's heap buffer, so
+     * a worker-owned scratch instance stops allocating once warmed up.
+     */
+    void reset() {
+        uwb_x = uwb_y = uwb_z = 0.0;
+        tag_id.clear();
+        has_dom = false;
+        is_array = false;
+        timestamp = 0.0;
+        has_timestamp = false;
+        raw = nullptr;
+    }
+};
+
 /**
  * @brief Core business logic for the UWB bridge
  * 
@@ -77,48 +183,147 @@ public:
      */
     bool isRunning() const { return running_; }
 
+    /**
+     * @brief Replay a capture log through the processing pipeline
+     *
+     * Re-injects every recorded message via onMessageReceived(), either at
+     * the recorded inter-arrival pacing (to reproduce production timing) or
+     * as fast as possible (the standard pipeline benchmark), then waits for
+     * the shard queues to drain. The bridge must be running; replayed
+     * messages flow through parse/transform/publish exactly like live ones.
+     *
+     * @param path Capture file written by CaptureWriter
+     * @param paced True to honor recorded timestamps, false for full speed
+     * @return true if the log was replayed completely
+     */
+    bool replayCapture(const std::string& path, bool paced);
+
+    /**
+     * @brief Apply new transform parameters to one floorplan at runtime
+     *
+     * Swaps the named floorplan's transformer snapshot (lock-free on the
+     * reader side); in-flight messages keep the old parameters, subsequent
+     * ones see the new. Intended for the Firestore listener.
+     *
+     * @param site_id Floorplan identifier ("default" for the fallback entry)
+     * @param config New transform parameters
+     * @return false if no floorplan with that site_id exists
+     */
+    bool updateFloorplanTransform(const std::string& site_id,
+                                  const uwb_transform::TransformConfig& config);
+
     /**
      * @brief Get current statistics
+     * @param reset_interval If true, latency histograms are reset so the next
+     *                       snapshot covers only the following interval
      * @return BridgeStats structure with current stats
      */
-    BridgeStats getStats() const;
+    BridgeStats getStats(bool reset_interval = false) const;
 
     /**
      * @brief Print statistics to log
+     * @param reset_interval Forwarded to getStats() - use for periodic
+     *                       "last N seconds" reporting
+     */
+    void printStats(bool reset_interval = false) const;
+
+    /**
+     * @brief Render all counters and histograms in Prometheus text format
+     *
+     * Called by the embedded metrics server on each scrape. Reads only
+     * atomics and histogram snapshots - never takes a lock the workers
+     * could be holding, so a scrape cannot stall the pipeline.
+     *
+     * @return Prometheus exposition-format text
      */
-    void printStats() const;
+    std::string renderMetrics() const;
 
 private:
+    struct WorkerShard;     // Defined below with the worker pool members
+    struct FloorplanEntry;  // Defined below with the floorplan registry
+
     /**
      * @brief Callback for incoming MQTT messages
-     * @param topic MQTT topic
-     * @param payload Message payload (JSON string)
+     *
+     * Runs on the MQTT callback thread. Only enqueues a work item on the
+     * bounded work queue; all parsing/transform/publish work happens on the
+     * worker pool so the callback thread is never blocked. The Paho message
+     * is shared by pointer, so the payload is never copied.
+     *
+     * @param msg Received MQTT message (shared, immutable)
+     */
+    void onMessageReceived(mqtt::const_message_ptr msg);
+
+    /**
+     * @brief Process a single work item (parse, transform, publish)
+     *
+     * Runs on a worker thread. Publishing happens synchronously here since
+     * worker threads are not Paho callback threads, so there is no deadlock
+     * risk and no need for per-message detached threads.
+     *
+     * @param shard Shard owning the item (for per-tag cached state)
+     * @param item Work item dequeued from the work queue
      */
-    void onMessageReceived(const std::string& topic, const std::string& payload);
+    void processMessage(WorkerShard& shard, const WorkItem& item);
 
     /**
-     * @brief Parse incoming JSON message
+     * @brief Main loop for a worker thread
+     *
+     * Dequeues work items from this worker's shard queue until shutdown is
+     * requested and the queue has been drained, giving stop() deterministic
+     * completion.
+     *
+     * @param shard_index Index of the shard this worker owns
+     */
+    void workerLoop(size_t shard_index);
+
+    /**
+     * @brief Parse incoming JSON message (single parse for the whole pipeline)
+     *
+     * Tries the zero-allocation SAX fast path for the known Pozyx schema
+     * first and falls back to the generic DOM parse for anything else.
+     *
      * @param payload JSON string
-     * @param uwb_x Output: UWB X coordinate
-     * @param uwb_y Output: UWB Y coordinate
-     * @param uwb_z Output: UWB Z coordinate (optional)
-     * @param tag_id Output: Tag identifier
+     * @param msg Output: extracted coordinates and tag ID (plus DOM on the fallback path)
      * @return true if parsing successful
      */
-    bool parseMessage(const std::string& payload, 
-                     double& uwb_x, double& uwb_y, double& uwb_z,
-                     std::string& tag_id);
+    bool parseMessage(const std::string& payload, ParsedMessage& msg);
+
+    /**
+     * @brief SAX fast path for the known Pozyx payload schema
+     *
+     * Extracts data.coordinates.{x,y,z}, the tag ID (top-level tagId or
+     * tagData.tagId) and the top-level timestamp without materializing a
+     * DOM, and records the byte spans the splice writer patches at output
+     * time. 99% of our traffic matches this schema. Payloads whose spans
+     * cannot be pinned down for verbatim splicing are declined so they take
+     * the generic DOM path, which reproduces every shape.
+     *
+     * @param payload JSON string (must outlive msg - msg.raw points at it)
+     * @param msg Output: extracted fields and spans (has_dom stays false)
+     * @return true if the payload matched the Pozyx schema
+     */
+    bool parsePozyxFastPath(const std::string& payload, ParsedMessage& msg);
 
     /**
-     * @brief Transform coordinates using the configured transformer
+     * @brief Transform coordinates using a floorplan's transformer
+     *
+     * Full 3D: X, Y and Z go through the transformer's precomputed
+     * homogeneous matrix in one call, so the unit conversion (and any
+     * configured z_offset/z_scale) needs no per-message branching here.
+     *
+     * @param floorplan Floorplan entry routed for this message's topic
      * @param uwb_x Input UWB X coordinate (mm)
      * @param uwb_y Input UWB Y coordinate (mm)
-     * @param meter_x Output transformed X coordinate (meters)
-     * @param meter_y Output transformed Y coordinate (meters)
+     * @param uwb_z Input UWB Z coordinate (mm)
+     * @param meter_x Output transformed X coordinate (floorplan's units)
+     * @param meter_y Output transformed Y coordinate (floorplan's units)
+     * @param meter_z Output transformed Z coordinate (floorplan's units)
      * @return true if transformation successful
      */
-    bool transformCoordinates(double uwb_x, double uwb_y,
-                            double& meter_x, double& meter_y);
+    bool transformCoordinates(const FloorplanEntry& floorplan,
+                            double uwb_x, double uwb_y, double uwb_z,
+                            double& meter_x, double& meter_y, double& meter_z);
 
     /**
      * @brief Create output JSON message from transformed coordinates
@@ -134,32 +339,168 @@ private:
                                    uint64_t timestamp);
 
     /**
-     * @brief Process and modify input JSON message with transformed coordinates
-     * @param payload Original JSON payload (will be modified in-place)
+     * @brief Patch transformed coordinates into the already-parsed message
+     * @param floorplan Floorplan entry (frame ID / units stamped on the output)
+     * @param msg Parsed message from parseMessage() (DOM is modified in-place)
      * @param transformed_x Transformed X coordinate
      * @param transformed_y Transformed Y coordinate
      * @param transformed_z Transformed Z coordinate
-     * @return Modified JSON string for publishing
+     * @return JSON string for publishing
      */
-    std::string processAndModifyMessage(const std::string& payload,
-                                       double transformed_x, 
-                                       double transformed_y, 
+    std::string processAndModifyMessage(const FloorplanEntry& floorplan,
+                                       ParsedMessage& msg,
+                                       double transformed_x,
+                                       double transformed_y,
                                        double transformed_z);
 
     /**
-     * @brief Extract tag ID from MQTT topic
-     * @param topic Full MQTT topic (e.g., "tags/0x1234")
-     * @return Tag ID string
+     * @brief Splice transformed values into the original payload bytes
+     *
+     * Output writer for the SAX fast path: copies msg.raw verbatim and
+     * applies the patches located by the span scanner - the x/y/z values
+     * are replaced with the transformed coordinates via std::to_chars,
+     * the frame_id / processing_timestamp / units fields (and z, when the
+     * input had none) are inserted before the coordinates object closes,
+     * and the anchorData member is dropped. Every other byte - sibling
+     * fields, extra array elements, key order, whitespace - passes
+     * through untouched, so the published content matches what the DOM
+     * path produces without building a DOM or paying a dump().
+     *
+     * @param floorplan Floorplan entry (frame ID / units stamped on the output)
+     * @param msg Parsed message from the SAX fast path (raw + spans set)
+     * @param x Transformed X coordinate
+     * @param y Transformed Y coordinate
+     * @param z Transformed Z coordinate
+     * @param out Output buffer the JSON text is appended to (reused per worker)
+     */
+    void createJsonOutput(const FloorplanEntry& floorplan, const ParsedMessage& msg,
+                          double x, double y, double z, std::string& out);
+
+    /**
+     * @brief Append one minimal bare position object (no array wrapper)
+     *
+     * Used by the batch path, which joins bare objects with commas inside
+     * one site-level array (batch elements deliberately carry the minimal
+     * position shape, not the full payload), and as createJsonOutput()'s
+     * fallback when no raw payload is available to splice.
+     */
+    void appendJsonPosition(const FloorplanEntry& floorplan, const ParsedMessage& msg,
+                            double x, double y, double z, std::string& out);
+
+    /**
+     * @brief Build the minimal flat position document used by the binary
+     *        formats and the batch path
      */
-    std::string extractTagIdFromTopic(const std::string& topic);
+    nlohmann::json makePositionDoc(const FloorplanEntry& floorplan,
+                                   const ParsedMessage& msg,
+                                   double x, double y, double z);
+
+    /**
+     * @brief Append a transformed position to its site's open batch
+     *
+     * Batch mode (processing.batch_window_ms > 0) trades one PUBLISH packet
+     * per position for one packet per site per window. Elements use the
+     * minimal position shape regardless of how the input parsed: Json joins
+     * appendJsonPosition() objects into an array, Cbor/MsgPack accumulate
+     * makePositionDoc() entries encoded once at flush, CompactBinary
+     * concatenates the self-delimiting packed records.
+     *
+     * Opens the window (arming the worker's flush deadline) if this is the
+     * first position since the last flush. Touched only by the owning worker.
+     */
+    void appendToBatch(WorkerShard& shard, const FloorplanEntry& floorplan,
+                       const ParsedMessage& msg, double x, double y, double z);
+
+    /**
+     * @brief Publish and reset every non-empty site batch on this shard
+     *
+     * Called by workerLoop() when the flush deadline passes and once more on
+     * shutdown so a partial window is never dropped. Success/failure counters
+     * are bumped here, by the number of positions the batch carried.
+     */
+    void flushBatches(WorkerShard& shard);
+
+    /**
+     * @brief Build a minimal position document for the CBOR/MessagePack formats
+     *
+     * Downstream binary consumers only need tag, position, timestamps,
+     * frame and units - the full nested Pozyx shape is not reproduced.
+     *
+     * @param msg Parsed message (tag ID and original timestamp)
+     * @param x Transformed X coordinate
+     * @param y Transformed Y coordinate
+     * @param z Transformed Z coordinate
+     * @param out Output buffer the encoded bytes are appended to (reused per worker)
+     */
+    void createBinaryOutput(const FloorplanEntry& floorplan, const ParsedMessage& msg,
+                            double x, double y, double z, std::string& out);
+
+    /**
+     * @brief Serialize a position as the compact fixed-field wire struct
+     *
+     * Layout (little-endian, packed):
+     *   uint8   magic (0xB5)
+     *   uint8   version (1)
+     *   uint8   units (OutputUnits enum value)
+     *   uint8   tag_len
+     *   char[]  tag (tag_len bytes, no terminator)
+     *   double  x, y, z
+     *   double  timestamp (original payload timestamp, 0 if absent)
+     *   uint64  processing_timestamp_ms
+     *
+     * @param msg Parsed message (tag ID and original timestamp)
+     * @param x Transformed X coordinate
+     * @param y Transformed Y coordinate
+     * @param z Transformed Z coordinate
+     * @param out Output buffer the packed bytes are appended to (reused per worker)
+     */
+    void createCompactBinaryOutput(const FloorplanEntry& floorplan,
+                                   const ParsedMessage& msg,
+                                   double x, double y, double z, std::string& out);
+
 
     /**
      * @brief Get current Unix timestamp in milliseconds
      */
     static uint64_t getCurrentTimestampMs();
 
+    /**
+     * @brief One registered floorplan: transformer plus per-floorplan output
+     *        parameters resolved once at initialization
+     *
+     * Entries are immutable after initialize() (transform parameter updates
+     * go through the transformer's lock-free snapshot swap), so workers read
+     * them without locking.
+     */
+    struct FloorplanEntry {
+        std::string site_id;        ///< Identifier for runtime config updates
+        std::string topic_prefix;   ///< Incoming-topic prefix ("" = fallback)
+        std::unique_ptr<uwb_transform::FloorplanTransformer> transformer;
+        uwb_transform::OutputUnits units;  ///< Resolved output unit enum
+        std::string units_str;      ///< Output units string for payloads
+        std::string frame_id;       ///< Frame ID stamped on output coordinates
+    };
+
+    /**
+     * @brief Route a topic to its floorplan by longest matching prefix
+     *
+     * One walk of the precompiled topic matcher trie - no per-pattern scan
+     * and no allocation. The result is still cached per tag in TagState,
+     * so steady state does even this walk once per tag, not per message.
+     *
+     * @param topic Incoming MQTT topic
+     * @return Matching entry (the fallback entry if nothing matches)
+     */
+    const FloorplanEntry* routeFloorplan(const std::string& topic) const;
+
     AppConfig config_;
-    std::unique_ptr<uwb_transform::FloorplanTransformer> transformer_;
+    /// Output wire format resolved once from config
+    OutputFormat output_format_{OutputFormat::Json};
+    /// Floorplan registry, sorted by topic prefix length (fallback last)
+    std::vector<FloorplanEntry> floorplans_;
+    /// Registry prefixes compiled into a segment trie at initialize();
+    /// read-only afterwards, shared by the callback and worker threads
+    TopicMatcher topic_matcher_;
     std::unique_ptr<MqttHandler> mqtt_source_handler_;   // Subscribe to source broker
     std::unique_ptr<MqttHandler> mqtt_dest_handler_;     // Publish to destination broker
     bool dual_mqtt_mode_{false};  // True if using separate source/dest brokers
@@ -167,13 +508,130 @@ private:
     std::atomic<bool> running_{false};
     std::atomic<bool> initialized_{false};
     std::atomic<bool> shutdown_requested_{false};  // For graceful thread termination
-    
-    // Statistics (atomic for thread safety)
-    std::atomic<uint64_t> total_messages_{0};
-    std::atomic<uint64_t> successful_transforms_{0};
-    std::atomic<uint64_t> failed_transforms_{0};
-    std::atomic<uint64_t> malformed_messages_{0};
-    std::atomic<uint64_t> total_processing_time_us_{0};
+    std::atomic<bool> publish_ready_{false};       // Destination broker connected; workers
+                                                   // queue (but don't process) until then
+
+    /**
+     * @brief Per-tag cached state, owned exclusively by one shard's worker
+     *
+     * The output topic is built once per tag, so steady-state publishing does
+     * zero topic string allocations, and the counters give per-tag stats for
+     * free.
+     */
+    struct TagState {
+        std::string output_topic;  ///< Prebuilt dest_topic_prefix + tag_id
+        const FloorplanEntry* floorplan = nullptr;
+                                   ///< Floorplan routed from this tag's topic (resolved once)
+        uint64_t messages = 0;     ///< Messages processed for this tag
+        uint64_t publish_failures = 0;  ///< Failed publishes for this tag
+    };
+
+    /**
+     * @brief One processing shard: a worker thread plus its own bounded queue
+     *
+     * Messages for the same tag always hash to the same shard, so each tag
+     * sees FIFO ordering while distinct tags spread across all shards.
+     * With conflation enabled, a queued-but-unprocessed position for a tag
+     * is overwritten in place by a newer one, bounding queue memory to
+     * O(tags) under backpressure while keeping fresh data low-latency.
+     */
+    /**
+     * @brief Per-worker statistics block
+     *
+     * One block per shard, split across two cache lines: the first is
+     * written only by the owning worker, the second only by the MQTT
+     * callback thread (enqueue-side counters for the shard it routed to).
+     * The relaxed increments therefore never bounce a cacheline between
+     * cores the way the old shared counters did. getStats() and the
+     * metrics endpoint aggregate lazily across blocks.
+     */
+    struct alignas(64) ShardStats {
+        // Worker-written line
+        std::atomic<uint64_t> successful{0};         ///< Transformed and published
+        std::atomic<uint64_t> failed{0};             ///< Failed transform or publish
+        std::atomic<uint64_t> malformed{0};          ///< Rejected by the parser
+        std::atomic<uint64_t> processed{0};          ///< Work items fully handled
+        std::atomic<uint64_t> processing_time_us{0}; ///< Summed per-message work time
+
+        // Enqueue-side line (MQTT callback thread)
+        alignas(64) std::atomic<uint64_t> received{0}; ///< Messages routed to this shard
+        std::atomic<uint64_t> dropped{0};            ///< Dropped on full queue
+        std::atomic<uint64_t> conflated{0};          ///< Replaced by a newer position
+    };
+
+    /**
+     * @brief Accumulation state for one site's open publish batch
+     *
+     * Owned exclusively by the shard's worker; one entry per site the shard
+     * has seen. The buffers are reused across windows so steady-state
+     * batching allocates nothing.
+     */
+    struct SiteBatch {
+        std::string topic;    ///< Prebuilt dest_topic_prefix_batch + site_id
+        std::string payload;  ///< Json: comma-joined objects; CompactBinary: packed records
+        nlohmann::json docs;  ///< Cbor/MsgPack: array of position docs, encoded at flush
+        size_t count = 0;     ///< Positions accumulated in the open window
+    };
+
+    struct WorkerShard {
+        std::list<WorkItem> queue;     ///< Bounded per-shard FIFO queue
+        std::unordered_map<std::string, std::list<WorkItem>::iterator> pending;
+                                       ///< Tag -> queued item, for in-place conflation
+        std::mutex mutex;              ///< Protects queue and pending
+        std::condition_variable cv;    ///< Signals the worker on enqueue/shutdown
+        std::thread thread;            ///< The worker owning this shard
+        std::unordered_map<std::string, TagState> tags;
+                                       ///< Per-tag cache; touched only by the owning worker
+
+        // Worker-owned scratch buffers, reused across messages so steady-state
+        // processing stops hitting the global heap (and its lock) per message
+        ParsedMessage parse_scratch;   ///< Reused parse result (string capacity retained)
+        std::string out_buffer;        ///< Reused serialization output buffer
+
+        // Windowed batch publishing state (unused when batch_window_ is zero)
+        std::unordered_map<std::string, SiteBatch> batches;
+                                       ///< site_id -> open batch; owning worker only
+        std::chrono::steady_clock::time_point batch_deadline;
+                                       ///< When the open window must flush
+        bool batch_open = false;       ///< True while any site batch holds positions
+
+        ShardStats stats;              ///< This worker's counter block
+    };
+
+    // Capture log for record/replay (inactive unless processing.capture_file set)
+    CaptureWriter capture_;
+
+    // Shared-memory position ring for same-host consumers (inactive unless
+    // processing.shm_ring_name set)
+    ShmRingWriter shm_ring_;
+
+    // Prometheus /metrics endpoint (inactive unless metrics_port set)
+    MetricsServer metrics_server_;
+
+    // Sharded worker pool (shard count == processing.worker_threads)
+    std::vector<std::unique_ptr<WorkerShard>> shards_;
+    size_t queue_capacity_{1024};                  // Max queued items per shard before dropping
+    bool conflation_enabled_{true};                // Overwrite pending positions per tag
+    std::chrono::milliseconds batch_window_{0};    // Site-level batch flush window (0 = off)
+
+    /**
+     * @brief Fold the live shard counter blocks into retired_stats_
+     *
+     * Called before shards_ is cleared so counters survive stop()/start()
+     * cycles (stats have always been cumulative for the process lifetime).
+     */
+    void retireShardStats();
+
+    // Counters carried over from torn-down worker pools; getStats() sums
+    // this block plus the live per-shard blocks
+    ShardStats retired_stats_;
+
+    std::atomic<uint64_t> transform_updates_{0};   // Runtime transform config swaps
+
+    // Per-stage latency histograms (mutable: snapshots may reset from const getStats)
+    mutable LatencyHistogram parse_hist_;
+    mutable LatencyHistogram transform_hist_;
+    mutable LatencyHistogram publish_hist_;
     
     std::chrono::system_clock::time_point start_time_;
 };
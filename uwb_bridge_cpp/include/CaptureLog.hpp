@@ -0,0 +1,140 @@
+#ifndef CAPTURE_LOG_HPP
+#define CAPTURE_LOG_HPP
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace uwb_bridge {
+
+/**
+ * @brief Memory-mapped, length-prefixed binary capture log
+ *
+ * Records every received (timestamp, topic, payload) tuple for offline
+ * replay. The file starts with an 8-byte magic ("UWBCAP01") followed by
+ * packed records:
+ *
+ *   uint64  timestamp_us   (system clock, microseconds since epoch)
+ *   uint32  topic_len
+ *   uint32  payload_len
+ *   char[]  topic          (topic_len bytes, no terminator)
+ *   char[]  payload        (payload_len bytes)
+ *
+ * The writer appends via memcpy into a mapped region and grows the file in
+ * large chunks, so the hot path never issues a write() syscall; the kernel
+ * flushes dirty pages in the background. On close the file is truncated to
+ * the bytes actually written.
+ */
+class CaptureWriter {
+public:
+    CaptureWriter() = default;
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    /**
+     * @brief Create (truncate) the capture file and map the first chunk
+     * @param path Capture file path
+     * @return true on success
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Append one received message to the log
+     *
+     * Safe to call from the MQTT callback thread; serialized by an
+     * (uncontended) internal mutex.
+     *
+     * @param topic Message topic
+     * @param payload Message payload
+     * @param timestamp_us Receive timestamp (microseconds since epoch)
+     * @return true if the record was written
+     */
+    bool append(const std::string& topic, const std::string& payload,
+                uint64_t timestamp_us);
+
+    /**
+     * @brief Unmap, truncate to the written size and close the file
+     */
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+
+    /// Messages appended so far
+    uint64_t recordCount() const { return record_count_; }
+
+private:
+    /// Grow the file and remap if fewer than `bytes` remain
+    bool ensureCapacity(size_t bytes);
+
+    int fd_ = -1;
+    char* data_ = nullptr;       // Mapped region (whole file)
+    size_t mapped_size_ = 0;     // Current file/mapping size
+    size_t write_offset_ = 0;    // Next byte to write
+    uint64_t record_count_ = 0;
+    std::string path_;
+    std::mutex mutex_;
+};
+
+/**
+ * @brief Reader for CaptureWriter logs, for replay and analysis
+ *
+ * Maps the whole file read-only; record fields point into the mapping, so
+ * replay touches each byte exactly once with zero per-record allocations.
+ */
+class CaptureReader {
+public:
+    /**
+     * @brief One record in the capture log (views into the mapping)
+     */
+    struct Record {
+        uint64_t timestamp_us;   ///< Receive timestamp (us since epoch)
+        const char* topic;       ///< Topic bytes (not null-terminated)
+        uint32_t topic_len;
+        const char* payload;     ///< Payload bytes
+        uint32_t payload_len;
+    };
+
+    CaptureReader() = default;
+    ~CaptureReader();
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    /**
+     * @brief Map the capture file and validate the header
+     * @param path Capture file path
+     * @return true on success
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Read the next record
+     * @param out Filled with views into the mapped file
+     * @return true if a record was read, false at end of log (or on a
+     *         truncated trailing record)
+     */
+    bool next(Record& out);
+
+    /// Rewind to the first record
+    void rewind();
+
+    /**
+     * @brief Unmap and close the file
+     */
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+
+private:
+    int fd_ = -1;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t read_offset_ = 0;
+};
+
+} // namespace uwb_bridge
+
+#endif // CAPTURE_LOG_HPP
@@ -2,6 +2,7 @@
 #define CONFIG_LOADER_HPP
 
 #include <string>
+#include <vector>
 #include <nlohmann/json.hpp>
 
 namespace uwb_bridge {
@@ -23,6 +24,23 @@ struct MqttConfig {
     bool use_ssl;                ///< Enable SSL/TLS
     bool use_websockets;         ///< Use WebSocket transport (required for some cloud brokers like Pozyx)
     std::string ws_path;         ///< WebSocket path (default: "/mqtt")
+    int max_in_flight = 64;      ///< Max unconfirmed QoS>0 publishes before applying backpressure (0 = unlimited)
+    std::string dest_topic_prefix_binary = "processed-bin/";
+                                 ///< Parallel prefix for binary output formats, so payload
+                                 ///< types never mix on one topic
+    std::string dest_topic_prefix_batch = "processed-batch/";
+                                 ///< Prefix for windowed site-level batch topics
+                                 ///< (see ProcessingConfig::batch_window_ms)
+    int spool_memory_kb = 0;     ///< >0 enables the offline publish spool, with this
+                                 ///< in-memory cap; publishes during broker outages are
+                                 ///< buffered and replayed on reconnect instead of dropped
+    std::string spool_file;      ///< Overflow file the spool spills to when the memory
+                                 ///< cap is hit ("" = memory-only spool)
+    int spool_file_mb = 64;      ///< Byte cap for the overflow file
+    int spool_max_age_ms = 60000; ///< Spooled entries older than this are discarded
+                                 ///< at replay rather than delivered stale
+    int spool_drain_rate = 500;  ///< Replay rate cap on reconnect (messages/sec,
+                                 ///< 0 = unthrottled) so the burst can't starve live traffic
 };
 
 /**
@@ -44,8 +62,44 @@ struct TransformConfig {
     double rotation_rad;  ///< Rotation of UWB frame in radians
     bool x_flipped;       ///< True if UWB X axis opposes Image X axis
     bool y_flipped;       ///< True if UWB Y axis opposes Image Y axis
+    double z_offset = 0.0; ///< Floor height offset added to Z in the UWB frame (mm)
+    double z_scale = 1.0;  ///< Extra Z scale applied on top of the unit conversion
     std::string frame_id; ///< Frame ID to add to output coordinates
     std::string output_units; ///< Output units: "meters", "millimeters", or "pixels"
+    std::string output_format; ///< Wire format: "json" (default), "cbor", "msgpack", or "compact"
+};
+
+/**
+ * @brief One floorplan entry for multi-floorplan routing
+ *
+ * Incoming topics starting with topic_prefix are transformed with this
+ * floorplan's parameters. The site_id identifies the entry for runtime
+ * config updates (e.g. from the Firestore listener).
+ */
+struct FloorplanConfig {
+    std::string site_id;       ///< Unique identifier for config updates
+    std::string topic_prefix;  ///< Incoming-topic prefix routed to this floorplan
+    TransformConfig transform; ///< Transform parameters for this floorplan
+};
+
+/**
+ * @brief Configuration structure for the message processing pipeline
+ */
+struct ProcessingConfig {
+    int worker_threads = 4;     ///< Number of worker threads / tag shards (tags hash to a fixed worker)
+    int queue_capacity = 1024;  ///< Bounded per-shard queue capacity (messages); overflow is dropped
+    bool conflation = true;     ///< Keep only the newest pending position per tag under backpressure
+    std::string capture_file;   ///< If set, every received message is appended to this
+                                ///< memory-mapped capture log for offline replay
+    std::string shm_ring_name;  ///< If set (e.g. "/uwb_positions"), transformed positions are
+                                ///< also published into this POSIX shared-memory ring for
+                                ///< same-host consumers
+    int shm_ring_capacity = 4096; ///< Slots in the shared-memory ring (rounded up to a power of two)
+    bool shm_ring_only = false; ///< Output via the ring only, skipping the MQTT publish
+    int batch_window_ms = 0;    ///< If > 0, positions are aggregated per site for this many
+                                ///< milliseconds and published as one array message on
+                                ///< dest_topic_prefix_batch + site_id instead of one MQTT
+                                ///< packet per position (0 = per-tag publishing)
 };
 
 /**
@@ -53,11 +107,16 @@ struct TransformConfig {
  */
 struct AppConfig {
     DualMqttConfig mqtt;
-    TransformConfig transform;
+    TransformConfig transform;    ///< Default floorplan (also the routing fallback)
+    std::vector<FloorplanConfig> floorplans;
+                                  ///< Additional floorplans, matched by topic prefix
+                                  ///< (empty = single-floorplan mode)
+    ProcessingConfig processing;
     std::string log_level;        ///< Logging level (trace, debug, info, warn, error)
     std::string log_file;         ///< Log file path (empty for console only)
     int log_rotation_size_mb;     ///< Log rotation size in MB
     int log_rotation_count;       ///< Number of rotated log files to keep
+    int metrics_port = 0;         ///< Prometheus /metrics HTTP port (0 = disabled)
 };
 
 /**
@@ -76,6 +135,20 @@ public:
      */
     static AppConfig loadFromFile(const std::string& config_path);
 
+    /**
+     * @brief Persist configuration to a JSON file (atomic replace)
+     *
+     * Writes the same schema loadFromFile() reads, so a saved config can be
+     * loaded straight back. Used as the write-through local cache for
+     * Firestore-fetched configs: the file is written to a temp path and
+     * renamed, so a crash mid-write never leaves a truncated cache.
+     *
+     * @param config Configuration to persist
+     * @param config_path Destination file path
+     * @throws std::runtime_error if the file cannot be written
+     */
+    static void saveToFile(const AppConfig& config, const std::string& config_path);
+
     /**
      * @brief Validate configuration parameters
      * @param config Configuration to validate
@@ -6,9 +6,13 @@
 #include <firebase/app.h>
 #include <firebase/auth.h>
 #include <firebase/firestore.h>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <future>
 #include <string>
+#include <thread>
 
 namespace uwb_bridge {
 
@@ -24,6 +28,24 @@ namespace uwb_bridge {
  */
 class FirestoreManager {
 public:
+    /// Default path of the write-through local config cache
+    static constexpr const char* kDefaultCachePath = "config/firestore_cache.json";
+
+    /**
+     * @brief Load the last successfully fetched config from the local cache
+     *
+     * Reads the cache written by fetchAppConfig() so the bridge can start
+     * serving traffic immediately, before (or without) a Firestore round
+     * trip. Requires no Firebase initialization - safe to call first thing
+     * on startup.
+     *
+     * @param config Filled with the cached configuration on success
+     * @param cache_path Cache file path
+     * @return true if a valid cached config was loaded
+     */
+    static bool loadCachedConfig(AppConfig& config,
+                                 const std::string& cache_path = kDefaultCachePath);
+
     /**
      * @brief Constructor
      */
@@ -71,11 +93,15 @@ public:
 
     /**
      * @brief Start real-time listener for TransformConfig updates
-     * 
-     * Sets up an OnSnapshot listener on "configs/transform_config" document.
-     * Whenever the document changes in Firestore, automatically calls
-     * transformer->updateConfig() with the new values.
-     * 
+     *
+     * Sets up an OnSnapshot listener on the transform config document.
+     * Snapshot callbacks only deposit the parsed values into a coalescing
+     * slot; a dedicated applier thread calls transformer->updateConfig()
+     * with the newest value at a capped rate. Dragging the calibration in
+     * the admin UI fires dozens of snapshots per second - applying each one
+     * would take the transformer's writer lock that often, stalling readers
+     * repeatedly for intermediate values nobody needs.
+     *
      * @param transformer Shared pointer to the FloorplanTransformer to update
      * @return true if listener successfully attached, false otherwise
      */
@@ -107,12 +133,43 @@ private:
      */
     uwb_bridge::TransformConfig parseTransformConfig(const firebase::firestore::DocumentSnapshot& snapshot);
 
+    /**
+     * @brief Apply coalesced transform updates at a capped rate
+     *
+     * Waits for the listener to bump the slot version, applies the newest
+     * value, then pauses for the apply interval - snapshots arriving during
+     * the pause overwrite each other in the slot, so a burst collapses to
+     * its final value.
+     *
+     * @param transformer Transformer receiving the updates
+     */
+    void transformApplierLoop(std::shared_ptr<uwb_transform::FloorplanTransformer> transformer);
+
+    /**
+     * @brief Signal the applier thread to exit and join it
+     */
+    void stopTransformApplier();
+
+    /// Minimum spacing between updateConfig() calls (10 applies/sec cap)
+    static constexpr int TRANSFORM_APPLY_INTERVAL_MS = 100;
+
     firebase::App* app_;                                        ///< Firebase App instance
     firebase::auth::Auth* auth_;                                ///< Firebase Auth instance (required for service account auth)
     firebase::firestore::Firestore* db_;                        ///< Firestore database instance
     firebase::firestore::ListenerRegistration transform_listener_; ///< Transform config listener
     bool initialized_;                                          ///< Initialization state
     std::string project_id_;                                    ///< Firebase project ID
+
+    // Coalescing slot between the Firestore callback thread and the applier:
+    // the listener overwrites config and bumps version under the mutex; the
+    // applier only ever reads the newest value, so a snapshot burst costs
+    // one updateConfig() per apply interval instead of one per snapshot
+    std::mutex pending_mutex_;                                  ///< Protects pending_config_/pending_version_
+    uwb_transform::TransformConfig pending_config_;             ///< Newest parsed transform values
+    uint64_t pending_version_ = 0;                              ///< Bumped on every listener write
+    std::condition_variable pending_cv_;                        ///< Wakes the applier on new values
+    std::thread transform_applier_;                             ///< Applies coalesced updates
+    std::atomic<bool> applier_stop_{false};                     ///< Tells the applier to exit
 };
 
 } // namespace uwb_bridge
@@ -0,0 +1,135 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+
+namespace uwb_bridge {
+
+/**
+ * @brief Fixed-memory latency histogram with HdrHistogram-style bucketing
+ *
+ * Values (microseconds) are bucketed logarithmically: each power-of-two
+ * octave is split into 16 linear sub-buckets, covering ~1us to ~60s with
+ * a worst-case quantile error of about 6%. Recording is a single relaxed
+ * atomic increment, so it is safe and cheap to call from all worker
+ * threads concurrently. Memory is a fixed array of counters - nothing is
+ * allocated per sample.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 4;                   ///< 16 linear sub-buckets per octave
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kOctaves = 27;                        ///< Covers up to ~67s in microseconds
+    static constexpr int kBucketCount = kOctaves * kSubBuckets;
+
+    /**
+     * @brief Aggregated view of the recorded values
+     */
+    struct Snapshot {
+        uint64_t count = 0;   ///< Number of recorded values
+        uint64_t max_us = 0;  ///< Maximum recorded value (microseconds)
+        uint64_t p50_us = 0;  ///< Median (microseconds)
+        uint64_t p90_us = 0;  ///< 90th percentile (microseconds)
+        uint64_t p99_us = 0;  ///< 99th percentile (microseconds)
+    };
+
+    /**
+     * @brief Record one latency value
+     * @param value_us Latency in microseconds
+     */
+    void record(uint64_t value_us) {
+        buckets_[bucketIndex(value_us)].fetch_add(1, std::memory_order_relaxed);
+
+        // Track exact max with a CAS loop (rarely contended)
+        uint64_t prev = max_us_.load(std::memory_order_relaxed);
+        while (value_us > prev &&
+               !max_us_.compare_exchange_weak(prev, value_us, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief Take a snapshot of the recorded distribution
+     * @param reset If true, counters are cleared so the next snapshot covers
+     *              only the following interval ("last N seconds" mode)
+     * @return Snapshot with count, max and p50/p90/p99
+     */
+    Snapshot snapshot(bool reset = false) {
+        std::array<uint64_t, kBucketCount> counts;
+        Snapshot snap;
+
+        for (int i = 0; i < kBucketCount; ++i) {
+            counts[i] = reset ? buckets_[i].exchange(0, std::memory_order_relaxed)
+                              : buckets_[i].load(std::memory_order_relaxed);
+            snap.count += counts[i];
+        }
+        snap.max_us = reset ? max_us_.exchange(0, std::memory_order_relaxed)
+                            : max_us_.load(std::memory_order_relaxed);
+
+        if (snap.count == 0) {
+            return snap;
+        }
+
+        snap.p50_us = percentile(counts, snap.count, 0.50);
+        snap.p90_us = percentile(counts, snap.count, 0.90);
+        snap.p99_us = percentile(counts, snap.count, 0.99);
+        return snap;
+    }
+
+private:
+    /**
+     * @brief Map a value to its bucket index (log octave + linear sub-bucket)
+     */
+    static int bucketIndex(uint64_t value_us) {
+        if (value_us < kSubBuckets) {
+            return static_cast<int>(value_us);
+        }
+        // Position of the highest set bit gives the octave
+        int msb = 63 - __builtin_clzll(value_us);
+        int octave = msb - kSubBucketBits + 1;
+        if (octave >= kOctaves - 1) {
+            octave = kOctaves - 1;  // Clamp overly large values to the last octave
+        }
+        // Octave o >= 1 covers [kSubBuckets << (o-1), kSubBuckets << o);
+        // within it a value is (kSubBuckets + sub) << (o-1), so the
+        // sub-bucket is the bits below the leading 1, shifted by o-1
+        int sub = static_cast<int>((value_us >> (octave - 1)) & (kSubBuckets - 1));
+        return octave * kSubBuckets + sub;
+    }
+
+    /**
+     * @brief Representative value (upper edge) for a bucket index
+     */
+    static uint64_t bucketValue(int index) {
+        int octave = index / kSubBuckets;
+        uint64_t sub = static_cast<uint64_t>(index % kSubBuckets);
+        if (octave == 0) {
+            return sub;
+        }
+        return (kSubBuckets + sub + 1) << (octave - 1);
+    }
+
+    static uint64_t percentile(const std::array<uint64_t, kBucketCount>& counts,
+                               uint64_t total, double q) {
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total));
+        if (rank >= total) {
+            rank = total - 1;
+        }
+        uint64_t seen = 0;
+        for (int i = 0; i < kBucketCount; ++i) {
+            seen += counts[i];
+            if (seen > rank) {
+                return bucketValue(i);
+            }
+        }
+        return bucketValue(kBucketCount - 1);
+    }
+
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};  ///< Per-bucket counters
+    std::atomic<uint64_t> max_us_{0};                            ///< Exact maximum
+};
+
+} // namespace uwb_bridge
+
+#endif // LATENCY_HISTOGRAM_HPP
@@ -0,0 +1,62 @@
+#ifndef METRICS_SERVER_HPP
+#define METRICS_SERVER_HPP
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace uwb_bridge {
+
+/**
+ * @brief Minimal embedded HTTP server for Prometheus scrapes
+ *
+ * Serves GET /metrics with text produced by a caller-supplied render
+ * function and answers everything else with 404. Single-threaded and
+ * intentionally tiny: one blocking accept loop on a dedicated thread,
+ * one connection at a time, no keep-alive. Prometheus scrapes every few
+ * seconds, so this is all the throughput the endpoint will ever need,
+ * and none of it runs anywhere near the message hot path.
+ */
+class MetricsServer {
+public:
+    /// Produces the metrics exposition text for one scrape
+    using RenderFn = std::function<std::string()>;
+
+    MetricsServer() = default;
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    /**
+     * @brief Bind the listen socket and start the serve thread
+     * @param port TCP port to listen on (all interfaces)
+     * @param render Called once per scrape to produce the response body
+     * @return true if the socket was bound and the thread started
+     */
+    bool start(int port, RenderFn render);
+
+    /**
+     * @brief Stop the serve thread and close the listen socket
+     */
+    void stop();
+
+    bool isRunning() const { return running_.load(std::memory_order_relaxed); }
+
+private:
+    /// Accept loop run by the serve thread
+    void serveLoop();
+
+    /// Handle one accepted connection (read request, write response)
+    void handleConnection(int client_fd);
+
+    RenderFn render_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    int listen_fd_ = -1;
+};
+
+} // namespace uwb_bridge
+
+#endif // METRICS_SERVER_HPP
@@ -2,19 +2,30 @@
 #define MQTT_HANDLER_HPP
 
 #include "ConfigLoader.hpp"
+#include "LatencyHistogram.hpp"
+#include "OfflineSpool.hpp"
 #include <mqtt/async_client.h>
 #include <functional>
 #include <memory>
 #include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 namespace uwb_bridge {
 
 /**
  * @brief Callback function type for incoming MQTT messages
- * @param topic The topic the message was published to
- * @param payload The message payload as a string
+ *
+ * The Paho message is passed by shared pointer so the payload is never
+ * copied between broker receive and processing - consumers read the topic
+ * and payload directly from the message object and share ownership for as
+ * long as they need it.
+ *
+ * @param msg The received MQTT message (shared, immutable)
  */
-using MessageCallback = std::function<void(const std::string& topic, const std::string& payload)>;
+using MessageCallback = std::function<void(mqtt::const_message_ptr msg)>;
 
 /**
  * @brief Callback action listener for MQTT operations
@@ -44,11 +55,15 @@ private:
     int qos_;
     MessageCallback message_callback_;
     std::atomic<int> reconnect_attempts_{0};
+    std::atomic<uint64_t> connections_lost_{0};
     static constexpr int MAX_RECONNECT_ATTEMPTS = 10;
     static constexpr int RECONNECT_DELAY_MS = 5000;
 
+    std::function<void(mqtt::delivery_token_ptr)> delivery_callback_;
+    std::function<void()> reconnect_callback_;
+
     void reconnect();
-    
+
     // mqtt::callback interface
     void connection_lost(const std::string& cause) override;
     void message_arrived(mqtt::const_message_ptr msg) override;
@@ -65,6 +80,25 @@ public:
              const std::string& source_topic,
              int qos,
              MessageCallback callback);
+
+    /**
+     * @brief Set hook invoked when a QoS>0 publish is confirmed by the broker
+     */
+    void set_delivery_callback(std::function<void(mqtt::delivery_token_ptr)> cb) {
+        delivery_callback_ = std::move(cb);
+    }
+
+    /**
+     * @brief Set hook invoked after a successful reconnect (spool drain)
+     */
+    void set_reconnect_callback(std::function<void()> cb) {
+        reconnect_callback_ = std::move(cb);
+    }
+
+    /// Cumulative broker connection losses (never reset)
+    uint64_t connections_lost() const {
+        return connections_lost_.load(std::memory_order_relaxed);
+    }
 };
 
 /**
@@ -101,19 +135,50 @@ public:
 
     /**
      * @brief Publish message to MQTT topic
+     *
+     * While the broker is unreachable and the offline spool is enabled
+     * (spool_memory_kb > 0), the message is buffered for replay on
+     * reconnect and the call still returns true - "accepted for delivery".
+     * Without the spool, a publish during an outage fails as before.
+     *
      * @param topic Topic to publish to
      * @param payload Message payload
      * @param qos Quality of Service (default: use config value)
-     * @return true if publish initiated successfully
+     * @return true if publish initiated (or spooled) successfully
      */
     bool publish(const std::string& topic, const std::string& payload, int qos = -1);
 
+    /**
+     * @brief Delivery accounting snapshot for pipelined publishing
+     */
+    struct PublishStats {
+        uint64_t published = 0;          ///< Publishes initiated
+        uint64_t delivered = 0;          ///< Publishes confirmed by the broker
+        uint64_t backpressured = 0;      ///< Publishes rejected by the in-flight cap
+        int in_flight = 0;               ///< Currently unconfirmed QoS>0 publishes
+        LatencyHistogram::Snapshot delivery_latency;  ///< Publish-to-confirm latency (us)
+        uint64_t spool_replayed = 0;     ///< Spooled publishes delivered after reconnect
+        OfflineSpool::Stats spool;       ///< Offline spool counters and occupancy
+    };
+
+    /**
+     * @brief Get delivery accounting for pipelined publishing
+     * @param reset_interval If true, the latency histogram is reset
+     * @return PublishStats snapshot
+     */
+    PublishStats getPublishStats(bool reset_interval = false) const;
+
     /**
      * @brief Check if client is connected
      * @return true if connected to broker
      */
     bool isConnected() const;
 
+    /**
+     * @brief Cumulative broker connection losses since startup
+     */
+    uint64_t connectionsLost() const;
+
     /**
      * @brief Get connection statistics
      * @return String with connection info
@@ -121,17 +186,75 @@ public:
     std::string getStats() const;
 
 private:
+    /**
+     * @brief Handle broker confirmation of a QoS>0 publish
+     *
+     * Looks up the send timestamp by message ID, records the delivery
+     * latency and releases one in-flight slot.
+     *
+     * @param token Completed delivery token from Paho
+     */
+    void onDeliveryComplete(mqtt::delivery_token_ptr token);
+
+    /**
+     * @brief Publish assuming a live connection (no spooling on failure)
+     *
+     * The body of publish() minus the outage handling; also used by the
+     * spool drain so a replay that fails mid-flight can never re-spool a
+     * duplicate of the entry still at the spool front.
+     */
+    bool publishConnected(const std::string& topic, const std::string& payload, int qos);
+
+    /**
+     * @brief Start the background drain thread if the spool holds entries
+     *
+     * Called after connect() and from the reconnect hook. No-op if a drain
+     * is already running or the spool is empty.
+     */
+    void startSpoolDrain();
+
+    /**
+     * @brief Signal the drain thread to stop and join it
+     */
+    void stopSpoolDrain();
+
+    /**
+     * @brief Replay spooled publishes in order, capped at spool_drain_rate
+     *
+     * Stops (leaving the remainder spooled) if the connection drops again;
+     * backpressured replays retry the same entry, preserving order.
+     */
+    void spoolDrainLoop();
+
     MqttConfig config_;
     MessageCallback message_callback_;
-    
+
     std::unique_ptr<mqtt::async_client> client_;
     mqtt::connect_options conn_opts_;
     std::unique_ptr<ActionListener> sub_listener_;
     std::unique_ptr<Callback> callback_;
-    
+
     std::atomic<uint64_t> messages_received_{0};
     std::atomic<uint64_t> messages_published_{0};
     std::atomic<bool> connected_{false};
+
+    // Delivery-token accounting (pipelined publish)
+    std::atomic<int> in_flight_{0};                ///< Unconfirmed QoS>0 publishes
+    std::atomic<uint64_t> delivered_{0};           ///< Broker-confirmed publishes
+    std::atomic<uint64_t> backpressured_{0};       ///< Publishes rejected by the cap
+    mutable LatencyHistogram delivery_latency_;    ///< Publish-to-confirm latency
+    std::mutex inflight_mutex_;                    ///< Protects inflight_sent_
+    std::unordered_map<int, std::chrono::high_resolution_clock::time_point> inflight_sent_;
+                                                   ///< Message ID -> publish timestamp
+
+    // Offline spool for destination-broker outages (see OfflineSpool)
+    OfflineSpool spool_;
+    bool spool_enabled_{false};                    ///< Resolved from spool_memory_kb > 0
+    std::atomic<uint64_t> spool_replayed_{0};      ///< Spooled publishes delivered on drain
+    std::thread drain_thread_;                     ///< Replays the spool after reconnect
+    std::atomic<bool> drain_active_{false};        ///< A drain thread is running
+    std::atomic<bool> drain_stop_{false};          ///< Tells the drain thread to exit
+    std::mutex drain_mutex_;                       ///< Serializes drain start/stop
 };
 
 } // namespace uwb_bridge
@@ -0,0 +1,160 @@
+#ifndef OFFLINE_SPOOL_HPP
+#define OFFLINE_SPOOL_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace uwb_bridge {
+
+/**
+ * @brief Bounded offline buffer for publishes during broker outages
+ *
+ * Failed publishes are offered here instead of being dropped, and drained
+ * in arrival order once the connection comes back. Storage is tiered:
+ *
+ *  - a bounded in-memory FIFO holds the newest entries;
+ *  - when the memory cap is hit, the oldest entries spill to an
+ *    append-only memory-mapped overflow file (same growth strategy as
+ *    CaptureWriter), so long outages cost disk instead of RAM;
+ *  - when the file cap is also hit, entries conflate per topic - the
+ *    newest position per tag survives, matching the conflation policy of
+ *    the worker queues - and only distinct-topic overflow is dropped.
+ *
+ * Entries older than max_age are discarded at drain time rather than
+ * replayed; a position from minutes ago is stale, not late.
+ *
+ * All methods are serialized by an internal mutex. This is the outage
+ * path, not the hot path - clarity beats lock-free here.
+ */
+class OfflineSpool {
+public:
+    /**
+     * @brief Spool limits (fixed after configure())
+     */
+    struct Options {
+        size_t max_memory_bytes = 0;      ///< In-memory cap (0 disables the spool)
+        size_t max_file_bytes = 0;        ///< Overflow file cap (0 = memory only)
+        std::string file_path;            ///< Overflow file ("" = memory only)
+        std::chrono::milliseconds max_age{60000};
+                                          ///< Entries older than this are expired at drain
+    };
+
+    /**
+     * @brief Counters and occupancy snapshot
+     */
+    struct Stats {
+        uint64_t spooled = 0;     ///< Entries accepted
+        uint64_t dropped = 0;     ///< Entries evicted with no same-topic replacement
+        uint64_t conflated = 0;   ///< Entries replaced by a newer same-topic one
+        uint64_t expired = 0;     ///< Entries discarded at drain for exceeding max_age
+        uint64_t spilled = 0;     ///< Entries moved from memory to the overflow file
+        size_t pending = 0;       ///< Entries currently awaiting replay
+        size_t memory_bytes = 0;  ///< Current in-memory payload bytes
+    };
+
+    OfflineSpool() = default;
+    ~OfflineSpool();
+
+    OfflineSpool(const OfflineSpool&) = delete;
+    OfflineSpool& operator=(const OfflineSpool&) = delete;
+
+    /**
+     * @brief Set the spool limits (call once, before first offer())
+     */
+    void configure(const Options& options);
+
+    /**
+     * @brief Buffer one failed publish
+     * @param topic Destination topic (also the conflation key)
+     * @param payload Message payload
+     * @return true if the entry was stored (possibly replacing an older
+     *         same-topic entry), false if it had to be dropped
+     */
+    bool offer(const std::string& topic, const std::string& payload);
+
+    /**
+     * @brief Copy the oldest non-expired entry without removing it
+     *
+     * Expired entries encountered on the way are discarded. The entry
+     * stays at the front until pop(), so a failed replay attempt leaves
+     * the spool untouched.
+     *
+     * @param topic Filled with the entry's topic
+     * @param payload Filled with the entry's payload
+     * @return false if the spool is empty
+     */
+    bool peek(std::string& topic, std::string& payload);
+
+    /**
+     * @brief Remove the entry last returned by peek()
+     */
+    void pop();
+
+    /// True if no entries are awaiting replay
+    bool empty() const;
+
+    Stats getStats() const;
+
+    /**
+     * @brief Drop all pending entries and close the overflow file
+     */
+    void close();
+
+private:
+    /**
+     * @brief One buffered publish held in memory
+     */
+    struct Entry {
+        std::string topic;
+        std::string payload;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+
+    /// Move the oldest in-memory entry to the overflow file (caller holds mutex_)
+    bool spillOldestLocked();
+
+    /// Grow the overflow file and remap if fewer than `bytes` remain
+    bool ensureFileCapacityLocked(size_t bytes);
+
+    /// Open (truncate) and map the overflow file on first spill
+    bool openFileLocked();
+
+    /// True if the overflow file holds undrained records
+    bool fileHasPendingLocked() const { return file_read_offset_ < file_write_offset_; }
+
+    /// Read the record at file_read_offset_ (caller holds mutex_)
+    bool readFileRecordLocked(std::string& topic, std::string& payload,
+                              uint64_t& enqueued_ms, size_t& record_size) const;
+
+    Options options_;
+
+    // In-memory tier: FIFO list plus topic -> newest entry, for conflation
+    // (same queue/pending pairing as the worker shards)
+    std::list<Entry> entries_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> newest_;
+    size_t memory_bytes_ = 0;
+
+    // Overflow file tier (opened lazily on first spill)
+    int fd_ = -1;
+    char* file_data_ = nullptr;
+    size_t file_mapped_size_ = 0;
+    size_t file_write_offset_ = 0;
+    size_t file_read_offset_ = 0;
+    size_t file_pending_ = 0;
+
+    uint64_t spooled_ = 0;
+    uint64_t dropped_ = 0;
+    uint64_t conflated_ = 0;
+    uint64_t expired_ = 0;
+    uint64_t spilled_ = 0;
+
+    mutable std::mutex mutex_;
+};
+
+} // namespace uwb_bridge
+
+#endif // OFFLINE_SPOOL_HPP
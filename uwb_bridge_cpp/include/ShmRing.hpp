@@ -0,0 +1,153 @@
+#ifndef SHM_RING_HPP
+#define SHM_RING_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace uwb_bridge {
+
+/**
+ * @brief One fixed-size position record in the shared-memory ring
+ *
+ * Exactly two cache lines. The seq field doubles as the torn-read guard:
+ * the writer stores 0 before filling the payload and (logical_index + 1)
+ * after, so a reader that sees the same nonzero seq before and after its
+ * copy knows the copy is consistent.
+ */
+struct ShmPositionRecord {
+    std::atomic<uint64_t> seq;  ///< 0 while being written, else logical index + 1
+    double timestamp;           ///< Source timestamp from the payload (0 if absent)
+    uint64_t published_us;      ///< When the bridge wrote the record (us since epoch)
+    double x;                   ///< Transformed X in the floorplan's output units
+    double y;                   ///< Transformed Y in the floorplan's output units
+    double z;                   ///< Converted Z in the floorplan's output units
+    uint8_t units;              ///< uwb_transform::OutputUnits of x/y/z
+    uint8_t tag_len;            ///< Bytes of tag_id actually used
+    char tag_id[78];            ///< Tag identifier (truncated if longer)
+};
+
+static_assert(sizeof(ShmPositionRecord) == 128,
+              "ShmPositionRecord must stay two cache lines");
+
+// Shared mapping header; layout lives in ShmRing.cpp
+struct ShmRingHeader;
+
+/**
+ * @brief Lock-free shared-memory ring of transformed positions
+ *
+ * Optional same-host output path: consumers on the same box map the POSIX
+ * shared-memory object read-only and poll it instead of taking the loopback
+ * round trip through the MQTT broker. The object starts with a header
+ * (magic "UWBSHM01", record size, capacity, monotonic head counter) followed
+ * by a power-of-two array of ShmPositionRecord slots.
+ *
+ * Writers (the worker shards) claim a slot with one fetch_add on the head
+ * counter and fill it with plain stores - no locks, no syscalls. Readers
+ * track their own cursor, clamp it to head - capacity when they fall behind
+ * (old records are simply overwritten) and validate each copy against the
+ * slot's seq field. Publishing is therefore wait-free for the hot path and
+ * a slow consumer can never apply backpressure to the bridge.
+ */
+class ShmRingWriter {
+public:
+    ShmRingWriter() = default;
+    ~ShmRingWriter();
+
+    ShmRingWriter(const ShmRingWriter&) = delete;
+    ShmRingWriter& operator=(const ShmRingWriter&) = delete;
+
+    /**
+     * @brief Create (or reset) the shared-memory object and map it
+     * @param name POSIX shm name (leading '/', e.g. "/uwb_positions")
+     * @param capacity Ring capacity in records; rounded up to a power of two
+     * @return true on success
+     */
+    bool open(const std::string& name, uint32_t capacity);
+
+    /**
+     * @brief Publish one transformed position into the ring
+     *
+     * Safe to call concurrently from multiple worker shards; each call
+     * claims its own slot. Never blocks and never fails once the ring is
+     * open - the oldest record is overwritten when the ring is full.
+     */
+    void publish(const std::string& tag_id, double x, double y, double z,
+                 double timestamp, uint64_t published_us, uint8_t units);
+
+    /**
+     * @brief Unmap and unlink the shared-memory object
+     */
+    void close();
+
+    bool isOpen() const { return slots_ != nullptr; }
+
+    /// Records published so far
+    uint64_t recordCount() const;
+
+private:
+    ShmRingHeader* header_ = nullptr;
+    ShmPositionRecord* slots_ = nullptr;
+    size_t mapped_size_ = 0;
+    uint32_t capacity_ = 0;      // Power of two
+    int fd_ = -1;
+    std::string name_;
+};
+
+/**
+ * @brief Read-only consumer side of the position ring
+ *
+ * Each reader keeps an independent cursor; multiple consumers can follow the
+ * same ring without coordinating. next() copies the record out (128 bytes),
+ * so the returned data stays valid after the slot is overwritten.
+ */
+class ShmRingReader {
+public:
+    ShmRingReader() = default;
+    ~ShmRingReader();
+
+    ShmRingReader(const ShmRingReader&) = delete;
+    ShmRingReader& operator=(const ShmRingReader&) = delete;
+
+    /**
+     * @brief Map an existing ring read-only and validate the header
+     * @param name POSIX shm name the writer was opened with
+     * @return true on success
+     */
+    bool open(const std::string& name);
+
+    /**
+     * @brief Copy out the next unread record
+     *
+     * If the writer lapped this reader, the cursor jumps forward to the
+     * oldest still-valid record and the skipped count is added to
+     * droppedRecords().
+     *
+     * @param out Filled with a consistent copy of the record
+     * @return true if a record was read, false if the ring is empty
+     */
+    bool next(ShmPositionRecord& out);
+
+    /**
+     * @brief Unmap the ring (the writer owns the object's lifetime)
+     */
+    void close();
+
+    bool isOpen() const { return slots_ != nullptr; }
+
+    /// Records skipped because the writer lapped this reader
+    uint64_t droppedRecords() const { return dropped_; }
+
+private:
+    const ShmRingHeader* header_ = nullptr;
+    const ShmPositionRecord* slots_ = nullptr;
+    size_t mapped_size_ = 0;
+    uint32_t capacity_ = 0;
+    uint64_t cursor_ = 0;        // Next logical record to read
+    uint64_t dropped_ = 0;
+    int fd_ = -1;
+};
+
+} // namespace uwb_bridge
+
+#endif // SHM_RING_HPP
@@ -0,0 +1,86 @@
+#ifndef TOPIC_MATCHER_HPP
+#define TOPIC_MATCHER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace uwb_bridge {
+
+/**
+ * @brief Precompiled topic matcher for floorplan routing and tag-ID extraction
+ *
+ * Topic prefixes from the floorplan registry are compiled once at startup
+ * into a segment trie; match() then resolves a topic to its route and the
+ * tag ID (last topic segment) in a single left-to-right walk over
+ * string_views - no allocation, no per-pattern scan per message.
+ *
+ * Semantics match the previous longest-string-prefix scan exactly:
+ * patterns are plain prefixes, so "site1/tags/" matches any topic under
+ * that path and a pattern not ending in '/' prefix-matches its final
+ * segment ("site1/tag" matches "site1/tags/0x1"). The empty pattern is
+ * the catch-all fallback. Longest pattern wins.
+ *
+ * compile-time structure, read-only after addPattern() calls finish;
+ * match() is const and safe to call from all worker threads concurrently.
+ */
+class TopicMatcher {
+public:
+    /// Result of matching one topic
+    struct Match {
+        int route = -1;           ///< Index passed to addPattern(), -1 if no match
+        std::string_view tag_id;  ///< Last topic segment ("unknown" if none)
+    };
+
+    TopicMatcher();
+
+    /**
+     * @brief Add one pattern to the trie
+     *
+     * @param prefix Topic prefix ("" = catch-all fallback)
+     * @param route Caller's route index returned from match()
+     */
+    void addPattern(std::string_view prefix, int route);
+
+    /**
+     * @brief Resolve a topic to its route and tag ID
+     *
+     * Walks the trie segment by segment, keeping the deepest (= longest
+     * prefix) route seen. Zero allocation: the returned tag_id views into
+     * the caller's topic storage and must not outlive it.
+     *
+     * @param topic Incoming MQTT topic
+     * @return Match with the winning route and the extracted tag ID
+     */
+    Match match(std::string_view topic) const;
+
+    /**
+     * @brief Extract the tag ID (last segment) from a topic
+     *
+     * Same rule the bridge has always used: everything after the last '/',
+     * or "unknown" when the topic has no slash or ends with one.
+     *
+     * @param topic Incoming MQTT topic
+     * @return View into topic (or the static "unknown")
+     */
+    static std::string_view extractTagId(std::string_view topic);
+
+private:
+    /// One trie node; edges and partial-segment patterns are small linear
+    /// arrays - registries have a handful of floorplans, and the compile
+    /// step is startup-only
+    struct Node {
+        std::vector<std::pair<std::string, int>> edges;     ///< Full segment -> child node index
+        std::vector<std::pair<std::string, int>> partials;  ///< Segment prefix -> route (longest first)
+        int route = -1;  ///< Route for patterns ending in '/' at this depth
+    };
+
+    /// Find or create the child of nodes_[node] for a full segment
+    int childFor(int node, std::string_view segment);
+
+    std::vector<Node> nodes_;  ///< nodes_[0] is the root
+};
+
+} // namespace uwb_bridge
+
+#endif // TOPIC_MATCHER_HPP
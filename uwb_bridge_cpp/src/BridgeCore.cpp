@@ -1,6 +1,11 @@
 #include "BridgeCore.hpp"
 #include <spdlog/spdlog.h>
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdio>
+#include <future>
 #include <sstream>
 #include <iomanip>
 #include <thread>
@@ -8,6 +13,342 @@
 
 namespace uwb_bridge {
 
+namespace {
+
+/**
+ * @brief SAX handler for the known Pozyx payload schema
+ *
+ * Walks the JSON event stream and picks out data.coordinates.{x,y,z},
+ * the tag ID (top-level tagId or tagData.tagId) and the top-level
+ * timestamp, without building a DOM. Only the first element of an
+ * array-wrapped payload is considered, matching the DOM path.
+ */
+class PozyxSaxHandler : public nlohmann::json::json_sax_t {
+public:
+    double x = 0.0, y = 0.0, z = 0.0;
+    bool has_x = false, has_y = false, has_z = false;
+    std::string tag_id;
+    double timestamp = 0.0;
+    bool has_timestamp = false;
+    bool was_array = false;
+
+    bool null() override { pending_key_.clear(); return true; }
+
+    bool boolean(bool) override { pending_key_.clear(); return true; }
+
+    bool number_integer(number_integer_t val) override {
+        return handleNumber(static_cast<double>(val));
+    }
+
+    bool number_unsigned(number_unsigned_t val) override {
+        return handleNumber(static_cast<double>(val));
+    }
+
+    bool number_float(number_float_t val, const string_t&) override {
+        return handleNumber(val);
+    }
+
+    bool string(string_t& val) override {
+        if (!first_element_done_) {
+            if ((depth_ == tagdata_depth_ || depth_ == 1) && pending_key_ == "tagId") {
+                tag_id = val;
+            }
+        }
+        pending_key_.clear();
+        return true;
+    }
+
+    bool binary(binary_t&) override { pending_key_.clear(); return true; }
+
+    bool start_object(std::size_t) override {
+        ++depth_;
+        if (pending_key_ == "data") {
+            data_depth_ = depth_;
+        } else if (pending_key_ == "coordinates" && depth_ == data_depth_ + 1) {
+            coords_depth_ = depth_;
+        } else if (pending_key_ == "tagData") {
+            tagdata_depth_ = depth_;
+        }
+        pending_key_.clear();
+        return true;
+    }
+
+    bool key(string_t& val) override {
+        pending_key_ = val;
+        return true;
+    }
+
+    bool end_object() override {
+        if (depth_ == coords_depth_) coords_depth_ = -1;
+        if (depth_ == data_depth_) data_depth_ = -1;
+        if (depth_ == tagdata_depth_) tagdata_depth_ = -1;
+        --depth_;
+        if (depth_ == 0) {
+            // Only the first element of an array-wrapped payload counts
+            first_element_done_ = true;
+        }
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        if (depth_ == 0) {
+            was_array = true;
+        }
+        pending_key_.clear();
+        return true;
+    }
+
+    bool end_array() override { return true; }
+
+    bool parse_error(std::size_t, const std::string&,
+                     const nlohmann::json::exception&) override {
+        return false;
+    }
+
+private:
+    bool handleNumber(double val) {
+        if (!first_element_done_) {
+            if (depth_ == coords_depth_) {
+                if (pending_key_ == "x")      { x = val; has_x = true; }
+                else if (pending_key_ == "y") { y = val; has_y = true; }
+                else if (pending_key_ == "z") { z = val; has_z = true; }
+            } else if (depth_ == 1 && pending_key_ == "timestamp") {
+                timestamp = val;
+                has_timestamp = true;
+            }
+        }
+        pending_key_.clear();
+        return true;
+    }
+
+    int depth_ = 0;                 // Current object nesting depth
+    int data_depth_ = -1;           // Depth of the "data" object (-1 = not inside)
+    int coords_depth_ = -1;         // Depth of "data.coordinates"
+    int tagdata_depth_ = -1;        // Depth of "tagData"
+    bool first_element_done_ = false;
+    std::string pending_key_;       // Key awaiting its value
+};
+
+
+// --- Span scanner for the JSON splice writer ------------------------------
+//
+// Second, allocation-free pass over a payload the SAX handler already
+// validated: pins down the byte spans of the data.coordinates values, the
+// coordinates object's closing brace and the data.anchorData member (see
+// PozyxSpans). Anything the scanner cannot pin down - or a coordinates
+// object that already contains one of the keys the writer stamps, which
+// would need an in-place replace - fails the scan and sends the message to
+// the DOM path, whose patch-and-dump handles every shape.
+
+/// Advance past JSON whitespace
+size_t skipJsonWs(const std::string& p, size_t i) {
+    while (i < p.size() && (p[i] == ' ' || p[i] == '\t' ||
+                            p[i] == '\n' || p[i] == '\r')) {
+        ++i;
+    }
+    return i;
+}
+
+/// Advance past the string whose opening quote is at i; npos on truncation
+size_t skipJsonString(const std::string& p, size_t i) {
+    for (++i; i < p.size(); ++i) {
+        if (p[i] == '\\') {
+            ++i;
+        } else if (p[i] == '"') {
+            return i + 1;
+        }
+    }
+    return std::string::npos;
+}
+
+/// Advance past one complete value starting at i (string-aware nesting)
+size_t skipJsonValue(const std::string& p, size_t i) {
+    if (i >= p.size()) {
+        return std::string::npos;
+    }
+    if (p[i] == '"') {
+        return skipJsonString(p, i);
+    }
+    if (p[i] == '{' || p[i] == '[') {
+        int depth = 0;
+        while (i < p.size()) {
+            char c = p[i];
+            if (c == '"') {
+                i = skipJsonString(p, i);
+                if (i == std::string::npos) {
+                    return std::string::npos;
+                }
+                continue;
+            }
+            if (c == '{' || c == '[') {
+                ++depth;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) {
+                    return i + 1;
+                }
+            }
+            ++i;
+        }
+        return std::string::npos;
+    }
+    // Number or literal: runs to the next structural character
+    while (i < p.size() && p[i] != ',' && p[i] != '}' && p[i] != ']' &&
+           p[i] != ' ' && p[i] != '\t' && p[i] != '\n' && p[i] != '\r') {
+        ++i;
+    }
+    return i;
+}
+
+/**
+ * @brief Scan one object, recording spans of interest
+ *
+ * @param p Payload
+ * @param i Offset of the object's '{'
+ * @param ctx 0 = first element, 1 = "data", 2 = "data.coordinates"
+ * @param s Output spans
+ * @return One past the object's closing '}', or npos on failure
+ */
+size_t scanPozyxObject(const std::string& p, size_t i, int ctx, PozyxSpans& s) {
+    constexpr size_t npos = std::string::npos;
+    ++i;  // Past '{'
+    while (true) {
+        i = skipJsonWs(p, i);
+        if (i >= p.size()) {
+            return npos;
+        }
+        if (p[i] == '}') {
+            if (ctx == 2) {
+                s.coords_close = i;
+            }
+            return i + 1;
+        }
+        if (p[i] != '"') {
+            return npos;
+        }
+        const size_t key_start = i;
+        i = skipJsonString(p, i);
+        if (i == npos) {
+            return npos;
+        }
+        std::string_view key(p.data() + key_start + 1, i - key_start - 2);
+        i = skipJsonWs(p, i);
+        if (i >= p.size() || p[i] != ':') {
+            return npos;
+        }
+        i = skipJsonWs(p, i + 1);
+        if (i >= p.size()) {
+            return npos;
+        }
+
+        const size_t value_start = i;
+        if (ctx == 0 && key == "data" && p[i] == '{') {
+            i = scanPozyxObject(p, i, 1, s);
+        } else if (ctx == 1 && key == "coordinates" && p[i] == '{') {
+            i = scanPozyxObject(p, i, 2, s);
+        } else {
+            i = skipJsonValue(p, i);
+            if (i == npos) {
+                return npos;
+            }
+            if (ctx == 1 && key == "anchorData") {
+                s.anchor_begin = key_start;
+                s.anchor_end = i;
+                s.has_anchor = true;
+            } else if (ctx == 2) {
+                if (key == "x") {
+                    s.x_begin = value_start;
+                    s.x_end = i;
+                } else if (key == "y") {
+                    s.y_begin = value_start;
+                    s.y_end = i;
+                } else if (key == "z") {
+                    s.z_begin = value_start;
+                    s.z_end = i;
+                    s.has_z = true;
+                } else if (key == "frame_id" || key == "processing_timestamp" ||
+                           key == "units") {
+                    return npos;  // Writer stamps these - DOM path overwrites
+                }
+            }
+        }
+        if (i == npos) {
+            return npos;
+        }
+
+        i = skipJsonWs(p, i);
+        if (i >= p.size()) {
+            return npos;
+        }
+        if (p[i] == ',') {
+            ++i;
+        } else if (p[i] != '}') {
+            return npos;
+        }
+    }
+}
+
+/// Top-level scan: optional array wrapper, then the first element object
+bool scanPozyxSpans(const std::string& payload, PozyxSpans& s) {
+    size_t i = skipJsonWs(payload, 0);
+    if (i < payload.size() && payload[i] == '[') {
+        i = skipJsonWs(payload, i + 1);
+    }
+    if (i >= payload.size() || payload[i] != '{') {
+        return false;
+    }
+    s.elem_begin = i;
+    const size_t end = scanPozyxObject(payload, i, 0, s);
+    if (end == std::string::npos) {
+        return false;
+    }
+    s.elem_end = end;
+    // x and y spans are required; z and anchorData are optional
+    return s.x_end > s.x_begin && s.y_end > s.y_begin && s.coords_close != 0;
+}
+
+/**
+ * @brief Append a double as shortest-round-trip decimal text
+ *
+ * std::to_chars produces the same shortest representation json::dump()
+ * does, without the generic formatting machinery around it.
+ */
+void appendNumber(std::string& out, double value) {
+    char buf[32];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, res.ptr - buf);
+}
+
+void appendNumber(std::string& out, uint64_t value) {
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, res.ptr - buf);
+}
+
+/// Append a JSON string literal (quotes + minimal escaping)
+void appendJsonString(std::string& out, const std::string& value) {
+    out += '"';
+    for (char c : value) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+} // namespace
+
 BridgeCore::BridgeCore(const AppConfig& config)
     : config_(config), 
       start_time_(std::chrono::system_clock::now()) {
@@ -24,22 +365,83 @@ bool BridgeCore::initialize() {
     try {
         spdlog::info("Initializing BridgeCore components...");
 
-        // Initialize coordinate transformer
-        spdlog::info("Creating FloorplanTransformer...");
-        
-        uwb_transform::TransformConfig tf_config;
-        tf_config.origin_x = config_.transform.origin_x;
-        tf_config.origin_y = config_.transform.origin_y;
-        tf_config.scale = config_.transform.scale;
-        tf_config.rotation_rad = config_.transform.rotation_rad;
-        tf_config.x_flipped = config_.transform.x_flipped;
-        tf_config.y_flipped = config_.transform.y_flipped;
-
-        transformer_ = std::make_unique<uwb_transform::FloorplanTransformer>(tf_config);
-        spdlog::info("FloorplanTransformer created successfully");
-        spdlog::info("  Origin: ({}, {}) mm", tf_config.origin_x, tf_config.origin_y);
-        spdlog::info("  Scale: {} px/mm", tf_config.scale);
-        spdlog::info("  Rotation: {} rad", tf_config.rotation_rad);
+        // Build the floorplan registry: every configured floorplan plus the
+        // top-level transform as the fallback ("default") entry. Longest
+        // prefixes sort first so routing picks the most specific match.
+        spdlog::info("Building floorplan registry...");
+
+        auto makeEntry = [](const std::string& site_id,
+                            const std::string& topic_prefix,
+                            const TransformConfig& tc) {
+            uwb_transform::TransformConfig tf_config;
+            tf_config.origin_x = tc.origin_x;
+            tf_config.origin_y = tc.origin_y;
+            tf_config.scale = tc.scale;
+            tf_config.rotation_rad = tc.rotation_rad;
+            tf_config.x_flipped = tc.x_flipped;
+            tf_config.y_flipped = tc.y_flipped;
+            tf_config.z_offset = tc.z_offset;
+            tf_config.z_scale = tc.z_scale;
+
+            FloorplanEntry entry;
+            entry.site_id = site_id;
+            entry.topic_prefix = topic_prefix;
+            entry.transformer =
+                std::make_unique<uwb_transform::FloorplanTransformer>(tf_config);
+            // Resolve the output unit enum once; the hot path indexes
+            // precomputed per-unit matrices instead of comparing strings
+            if (tc.output_units == "pixels") {
+                entry.units = uwb_transform::OutputUnits::Pixels;
+            } else if (tc.output_units == "millimeters") {
+                entry.units = uwb_transform::OutputUnits::Millimeters;
+            } else {
+                entry.units = uwb_transform::OutputUnits::Meters;
+            }
+            entry.units_str = tc.output_units;
+            entry.frame_id = tc.frame_id;
+            return entry;
+        };
+
+        floorplans_.clear();
+        for (const auto& fp : config_.floorplans) {
+            floorplans_.push_back(makeEntry(fp.site_id, fp.topic_prefix, fp.transform));
+        }
+        floorplans_.push_back(makeEntry("default", "", config_.transform));
+        std::stable_sort(floorplans_.begin(), floorplans_.end(),
+                         [](const FloorplanEntry& a, const FloorplanEntry& b) {
+                             return a.topic_prefix.size() > b.topic_prefix.size();
+                         });
+        for (const auto& entry : floorplans_) {
+            spdlog::info("  Floorplan '{}': prefix='{}', units={}",
+                         entry.site_id, entry.topic_prefix, entry.units_str);
+        }
+
+        // Compile the registry prefixes into the topic-matcher trie; from
+        // here on routing and tag-ID extraction are one allocation-free walk
+        topic_matcher_ = TopicMatcher();
+        for (size_t i = 0; i < floorplans_.size(); ++i) {
+            topic_matcher_.addPattern(floorplans_[i].topic_prefix,
+                                      static_cast<int>(i));
+        }
+
+        // Resolve the output wire format once (validated by ConfigLoader)
+        if (config_.transform.output_format == "cbor") {
+            output_format_ = OutputFormat::Cbor;
+        } else if (config_.transform.output_format == "msgpack") {
+            output_format_ = OutputFormat::MsgPack;
+        } else if (config_.transform.output_format == "compact") {
+            output_format_ = OutputFormat::CompactBinary;
+        } else {
+            output_format_ = OutputFormat::Json;
+        }
+        if (output_format_ != OutputFormat::Json) {
+            spdlog::info("Binary output format '{}' - publishing under prefix '{}'",
+                         config_.transform.output_format,
+                         config_.mqtt.dest_broker.dest_topic_prefix_binary);
+        }
+
+        spdlog::info("Floorplan registry ready ({} entr{})",
+                     floorplans_.size(), floorplans_.size() == 1 ? "y" : "ies");
 
         // Initialize MQTT handlers
         spdlog::info("Creating MQTT handlers...");
@@ -51,8 +453,8 @@ bool BridgeCore::initialize() {
             // Source MQTT handler (subscribe only)
             mqtt_source_handler_ = std::make_unique<MqttHandler>(
                 config_.mqtt.source_broker,
-                [this](const std::string& topic, const std::string& payload) {
-                    this->onMessageReceived(topic, payload);
+                [this](mqtt::const_message_ptr msg) {
+                    this->onMessageReceived(std::move(msg));
                 }
             );
             spdlog::info("Source MQTT handler created: {}", config_.mqtt.source_broker.broker_address);
@@ -69,8 +471,8 @@ bool BridgeCore::initialize() {
             // Single broker for both subscribe and publish
             mqtt_source_handler_ = std::make_unique<MqttHandler>(
                 config_.mqtt.source_broker,
-                [this](const std::string& topic, const std::string& payload) {
-                    this->onMessageReceived(topic, payload);
+                [this](mqtt::const_message_ptr msg) {
+                    this->onMessageReceived(std::move(msg));
                 }
             );
             // In single mode, both pointers point to the same handler (no second unique_ptr)
@@ -101,32 +503,136 @@ bool BridgeCore::start() {
 
     spdlog::info("Starting BridgeCore...");
 
-    // Connect to MQTT broker(s)
+    // Open the capture log before any message can arrive
+    if (!config_.processing.capture_file.empty()) {
+        if (!capture_.open(config_.processing.capture_file)) {
+            spdlog::error("Failed to open capture log - continuing without capture");
+        }
+    }
+
+    // Open the shared-memory position ring for same-host consumers
+    if (!config_.processing.shm_ring_name.empty()) {
+        if (!shm_ring_.open(config_.processing.shm_ring_name,
+                            static_cast<uint32_t>(config_.processing.shm_ring_capacity))) {
+            if (config_.processing.shm_ring_only) {
+                // The ring is the only output path - refuse to start blind
+                spdlog::error("Failed to open shared-memory ring (shm_ring_only set)");
+                if (capture_.isOpen()) {
+                    capture_.close();
+                }
+                return false;
+            }
+            spdlog::error("Failed to open shared-memory ring - continuing with MQTT only");
+        }
+    }
+
+    // Start the sharded worker pool first (one queue per worker, tags hash
+    // to shards). Workers queue but don't process until publish_ready_, so
+    // messages arriving while the destination broker is still connecting
+    // are buffered (with conflation) instead of dropped.
+    queue_capacity_ = static_cast<size_t>(config_.processing.queue_capacity);
+    conflation_enabled_ = config_.processing.conflation;
+    batch_window_ = std::chrono::milliseconds(config_.processing.batch_window_ms);
+    if (batch_window_.count() > 0) {
+        spdlog::info("Batch publishing enabled: {} ms window, site topics under '{}'",
+                     batch_window_.count(),
+                     config_.mqtt.dest_broker.dest_topic_prefix_batch);
+    }
+    shutdown_requested_ = false;
+    publish_ready_ = false;
+    int num_workers = config_.processing.worker_threads;
+    spdlog::info("Starting {} worker shards (queue capacity: {} each)",
+                 num_workers, queue_capacity_);
+    shards_.clear();
+    shards_.reserve(num_workers);
+    for (int i = 0; i < num_workers; ++i) {
+        shards_.push_back(std::make_unique<WorkerShard>());
+    }
+    for (int i = 0; i < num_workers; ++i) {
+        shards_[i]->thread = std::thread(&BridgeCore::workerLoop, this,
+                                         static_cast<size_t>(i));
+    }
+
+    // Accept inbound messages as soon as the source subscription is live
+    running_ = true;
+
+    // Connect to the MQTT broker(s). In dual mode both connects run
+    // concurrently - over WAN links each takes seconds, so serial
+    // connection doubled startup time.
+    bool connected;
     if (dual_mqtt_mode_) {
-        spdlog::info("Connecting to source MQTT broker...");
-        if (!mqtt_source_handler_->connect()) {
+        spdlog::info("Connecting to source and destination MQTT brokers in parallel...");
+        auto source_future = std::async(std::launch::async, [this] {
+            return mqtt_source_handler_->connect();
+        });
+        auto dest_future = std::async(std::launch::async, [this] {
+            return mqtt_dest_handler_->connect();
+        });
+
+        bool source_ok = source_future.get();
+        bool dest_ok = dest_future.get();
+        if (!source_ok) {
             spdlog::error("Failed to connect to source MQTT broker");
-            return false;
         }
-        
-        spdlog::info("Connecting to destination MQTT broker...");
-        if (!mqtt_dest_handler_->connect()) {
+        if (!dest_ok) {
             spdlog::error("Failed to connect to destination MQTT broker");
-            // Disconnect source on failure to avoid partial state
-            mqtt_source_handler_->disconnect();
-            return false;
+        }
+        connected = source_ok && dest_ok;
+        if (!connected) {
+            // Disconnect whichever side came up to avoid partial state
+            if (source_ok) mqtt_source_handler_->disconnect();
+            if (dest_ok) mqtt_dest_handler_->disconnect();
         }
     } else {
         spdlog::info("Connecting to MQTT broker...");
-        if (!mqtt_source_handler_->connect()) {
+        connected = mqtt_source_handler_->connect();
+        if (!connected) {
             spdlog::error("Failed to connect to MQTT broker");
-            return false;
         }
     }
 
-    running_ = true;
+    if (!connected) {
+        // Tear the worker pool back down (nothing useful is queued)
+        running_ = false;
+        shutdown_requested_ = true;
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->cv.notify_all();
+        }
+        for (auto& shard : shards_) {
+            if (shard->thread.joinable()) {
+                shard->thread.join();
+            }
+        }
+        retireShardStats();
+        shards_.clear();
+        if (capture_.isOpen()) {
+            capture_.close();
+        }
+        if (shm_ring_.isOpen()) {
+            shm_ring_.close();
+        }
+        return false;
+    }
+
+    // Destination is up - release the workers to flush anything that
+    // queued while the brokers were connecting
+    publish_ready_ = true;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->cv.notify_all();
+    }
+
     start_time_ = std::chrono::system_clock::now();
-    
+
+    // Expose counters and histograms for Prometheus scrapes
+    if (config_.metrics_port > 0) {
+        if (!metrics_server_.start(config_.metrics_port,
+                                   [this] { return renderMetrics(); })) {
+            spdlog::warn("Metrics endpoint unavailable - continuing without it");
+        }
+    }
+
     spdlog::info("BridgeCore started successfully");
     spdlog::info("Listening for messages on topic: {}", config_.mqtt.source_broker.source_topic);
     
@@ -139,13 +645,37 @@ void BridgeCore::stop() {
     }
 
     spdlog::info("Stopping BridgeCore...");
-    
-    // Signal shutdown to all threads first
+
+    // Stop the scrape endpoint before tearing down what it reads
+    metrics_server_.stop();
+
+    // Signal shutdown; each worker drains its shard queue and then exits
     shutdown_requested_ = true;
-    
-    // Give publish threads time to complete
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->cv.notify_all();
+    }
+
+    // Join the worker pool - deterministic drain, no sleep guesswork
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+    }
+    retireShardStats();
+    shards_.clear();
+
+    // Finalize the capture log (trims preallocated space)
+    if (capture_.isOpen()) {
+        capture_.close();
+    }
+
+    // Tear down the shared-memory ring (unlinks the shm object)
+    if (shm_ring_.isOpen()) {
+        spdlog::info("Shared-memory ring: {} records published", shm_ring_.recordCount());
+        shm_ring_.close();
+    }
+
     running_ = false;
 
     // Print final statistics
@@ -168,125 +698,409 @@ void BridgeCore::stop() {
     spdlog::info("BridgeCore stopped");
 }
 
-void BridgeCore::onMessageReceived(const std::string& topic, const std::string& payload) {
+void BridgeCore::onMessageReceived(mqtt::const_message_ptr msg) {
     // Ignore messages if bridge not fully running (both brokers connected) or shutting down
     if (!running_ || shutdown_requested_) {
-        spdlog::debug("Ignoring message - bridge not ready or shutting down");
+        SPDLOG_DEBUG("Ignoring message - bridge not ready or shutting down");
         return;
     }
-    
+
     // Capture arrival timestamp immediately for end-to-end latency measurement
     auto arrival_time = std::chrono::high_resolution_clock::now();
-    auto start_time = arrival_time;
-    
-    spdlog::debug("BridgeCore::onMessageReceived called - Topic: {}, Payload: {}", topic, payload);
-    total_messages_++;
+
+    // Record to the capture log (mmap memcpy - negligible hot-path cost).
+    // Microsecond timestamps so paced replay reproduces inter-arrival gaps.
+    if (capture_.isOpen()) {
+        uint64_t now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        capture_.append(msg->get_topic(), msg->get_payload(), now_us);
+    }
+
+    SPDLOG_DEBUG("BridgeCore::onMessageReceived called - Topic: {}, Payload: {}",
+                  msg->get_topic(), msg->get_payload());
+
+    // Route to a shard by tag ID so messages for one tag stay FIFO on one
+    // worker; drop if the shard queue is full so the MQTT callback thread
+    // is never blocked under backpressure. Only the message pointer is
+    // passed around - the payload itself is never copied.
+    // The queue key and conflation map need an owning std::string (C++17
+    // unordered_map has no heterogeneous lookup), so materialize the view
+    // once here, outside the shard lock
+    std::string tag_id(TopicMatcher::extractTagId(msg->get_topic()));
+    size_t shard_index = std::hash<std::string>{}(tag_id) % shards_.size();
+    WorkerShard& shard = *shards_[shard_index];
+    shard.stats.received.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        // Latest-value conflation: if this tag already has a pending position,
+        // overwrite it in place - only the newest position matters for live
+        // tracking, and this bounds the queue to O(tags) under backpressure
+        if (conflation_enabled_) {
+            auto it = shard.pending.find(tag_id);
+            if (it != shard.pending.end()) {
+                it->second->msg = std::move(msg);
+                it->second->arrival_time = arrival_time;
+                shard.stats.conflated.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        if (shard.queue.size() >= queue_capacity_) {
+            shard.stats.dropped.fetch_add(1, std::memory_order_relaxed);
+            spdlog::warn("Shard {} queue full ({} items) - dropping message",
+                         shard_index, queue_capacity_);
+            return;
+        }
+        shard.queue.push_back(WorkItem{std::move(msg), tag_id, arrival_time});
+        if (conflation_enabled_) {
+            shard.pending.emplace(std::move(tag_id), std::prev(shard.queue.end()));
+        }
+    }
+    shard.cv.notify_one();
+}
+
+bool BridgeCore::replayCapture(const std::string& path, bool paced) {
+    if (!running_) {
+        spdlog::error("Cannot replay - bridge not running");
+        return false;
+    }
+
+    CaptureReader reader;
+    if (!reader.open(path)) {
+        return false;
+    }
+
+    spdlog::info("Replaying capture {} ({})", path,
+                 paced ? "recorded pacing" : "as fast as possible");
+
+    auto replay_start = std::chrono::steady_clock::now();
+    uint64_t first_ts_us = 0;
+    uint64_t injected = 0;
+
+    CaptureReader::Record rec;
+    while (reader.next(rec)) {
+        if (paced) {
+            // Sleep until this record's offset from the first timestamp has
+            // elapsed on the replay clock
+            if (first_ts_us == 0) {
+                first_ts_us = rec.timestamp_us;
+            } else if (rec.timestamp_us > first_ts_us) {
+                auto target = replay_start +
+                    std::chrono::microseconds(rec.timestamp_us - first_ts_us);
+                std::this_thread::sleep_until(target);
+            }
+        }
+
+        auto msg = mqtt::make_message(
+            std::string(rec.topic, rec.topic_len),
+            std::string(rec.payload, rec.payload_len));
+        onMessageReceived(std::move(msg));
+        injected++;
+    }
+    reader.close();
+
+    // Wait for the shard queues to drain so the reported duration covers
+    // processing, not just injection
+    for (;;) {
+        bool empty = true;
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            if (!shard->queue.empty()) {
+                empty = false;
+                break;
+            }
+        }
+        if (empty || shutdown_requested_) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - replay_start);
+    spdlog::info("Replayed {} messages in {:.2f} s ({:.0f} msg/sec)",
+                 injected, elapsed.count() / 1000.0,
+                 elapsed.count() > 0 ? injected * 1000.0 / elapsed.count() : 0.0);
+    return true;
+}
+
+void BridgeCore::workerLoop(size_t shard_index) {
+    WorkerShard& shard = *shards_[shard_index];
+    const bool batching = batch_window_.count() > 0;
+    bool drained = false;
+    while (!drained) {
+        WorkItem item;
+        bool have_item = false;
+        {
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            // publish_ready_ holds workers back while the destination broker
+            // is still connecting; messages keep queueing (and conflating)
+            auto ready = [this, &shard] {
+                return shutdown_requested_ ||
+                       (!shard.queue.empty() && publish_ready_);
+            };
+            if (batching && shard.batch_open) {
+                // Cap the wait at the flush deadline so a quiet shard still
+                // publishes its open batch on time
+                shard.cv.wait_until(lock, shard.batch_deadline, ready);
+            } else {
+                shard.cv.wait(lock, ready);
+            }
+
+            if (!shard.queue.empty() && (publish_ready_ || shutdown_requested_)) {
+                item = std::move(shard.queue.front());
+                shard.queue.pop_front();
+                if (conflation_enabled_) {
+                    shard.pending.erase(item.tag_id);
+                }
+                have_item = true;
+            } else if (shutdown_requested_ && shard.queue.empty()) {
+                // Shutdown requested and queue fully drained
+                drained = true;
+            }
+            // else: flush-deadline timeout with nothing queued
+        }
+
+        if (have_item) {
+            processMessage(shard, item);
+            shard.stats.processed.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (batching && shard.batch_open &&
+            (drained ||
+             std::chrono::steady_clock::now() >= shard.batch_deadline)) {
+            // Window expired (or shutting down - a partial window is never
+            // dropped); publish outside the shard lock
+            flushBatches(shard);
+        }
+    }
+}
+
+void BridgeCore::processMessage(WorkerShard& shard, const WorkItem& item) {
+    // Read topic and payload directly out of the shared Paho message
+    const std::string& topic = item.msg->get_topic();
+    const std::string& payload = item.msg->get_payload();
+    auto arrival_time = item.arrival_time;
+    auto start_time = std::chrono::high_resolution_clock::now();
 
     try {
-        // Parse message
-        double uwb_x, uwb_y, uwb_z = 0.0;
-        std::string tag_id;
+        // Parse message once into the worker-owned scratch instance; string
+        // capacity carries over between messages so warmed-up workers stop
+        // allocating in the parse stage
+        ParsedMessage& msg = shard.parse_scratch;
+        msg.reset();
 
-        spdlog::debug("Attempting to parse message...");
-        if (!parseMessage(payload, uwb_x, uwb_y, uwb_z, tag_id)) {
-            malformed_messages_++;
+        SPDLOG_DEBUG("Attempting to parse message...");
+        auto parse_start = std::chrono::high_resolution_clock::now();
+        if (!parseMessage(payload, msg)) {
+            shard.stats.malformed.fetch_add(1, std::memory_order_relaxed);
             spdlog::warn("Malformed message on topic {}", topic);
             return;
         }
-        
-        spdlog::debug("Parsed: tag_id='{}', x={}, y={}, z={}", tag_id, uwb_x, uwb_y, uwb_z);
+        auto parse_end = std::chrono::high_resolution_clock::now();
+        parse_hist_.record(std::chrono::duration_cast<std::chrono::microseconds>(
+            parse_end - parse_start).count());
+
+        SPDLOG_DEBUG("Parsed: tag_id='{}', x={}, y={}, z={}",
+                      msg.tag_id, msg.uwb_x, msg.uwb_y, msg.uwb_z);
 
         // If tag_id not in JSON, try to extract from topic
-        if (tag_id.empty()) {
-            tag_id = extractTagIdFromTopic(topic);
-            spdlog::debug("Extracted tag_id from topic: '{}'", tag_id);
+        if (msg.tag_id.empty()) {
+            msg.tag_id = std::string(TopicMatcher::extractTagId(topic));
+            SPDLOG_DEBUG("Extracted tag_id from topic: '{}'", msg.tag_id);
+        }
+        std::string tag_id = msg.tag_id;
+
+        // Resolve per-tag cached state up front: output topic and floorplan
+        // routing are computed once per tag, then reused for every message.
+        // The shard's tag table is only ever touched by this worker.
+        TagState& tag_state = shard.tags[tag_id];
+        if (!tag_state.floorplan) {
+            tag_state.floorplan = routeFloorplan(topic);
+            const std::string& prefix = (output_format_ == OutputFormat::Json)
+                ? config_.mqtt.dest_broker.dest_topic_prefix
+                : config_.mqtt.dest_broker.dest_topic_prefix_binary;
+            tag_state.output_topic = prefix + tag_id;
+            SPDLOG_DEBUG("Tag '{}' routed to floorplan '{}'",
+                          tag_id, tag_state.floorplan->site_id);
         }
+        const FloorplanEntry& floorplan = *tag_state.floorplan;
 
-        // Transform coordinates
-        spdlog::debug("Transforming coordinates...");
-        double meter_x, meter_y;
-        if (!transformCoordinates(uwb_x, uwb_y, meter_x, meter_y)) {
-            failed_transforms_++;
+        // Transform coordinates - one 3D call covers X, Y and Z, including
+        // the Z unit conversion that used to be a per-message switch here
+        SPDLOG_DEBUG("Transforming coordinates...");
+        auto xform_start = std::chrono::high_resolution_clock::now();
+        double meter_x, meter_y, transformed_z;
+        if (!transformCoordinates(floorplan, msg.uwb_x, msg.uwb_y, msg.uwb_z,
+                                  meter_x, meter_y, transformed_z)) {
+            shard.stats.failed.fetch_add(1, std::memory_order_relaxed);
             spdlog::error("Transformation failed for tag {}", tag_id);
             return;
         }
+        auto xform_end = std::chrono::high_resolution_clock::now();
+        transform_hist_.record(std::chrono::duration_cast<std::chrono::microseconds>(
+            xform_end - xform_start).count());
 
-        // Transform Z coordinate (simple unit conversion)
-        double transformed_z = uwb_z;
-        if (config_.transform.output_units == "meters") {
-            transformed_z = uwb_z / 1000.0;  // mm to meters
-        } else if (config_.transform.output_units == "pixels") {
-            transformed_z = uwb_z * config_.transform.scale;  // mm to pixels
+        // Same-host output: hand the position to co-located consumers through
+        // the shared-memory ring - wait-free, so a slow consumer can never
+        // stall this worker
+        if (shm_ring_.isOpen()) {
+            const uint64_t published_us =
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+            shm_ring_.publish(tag_id, meter_x, meter_y, transformed_z,
+                              msg.has_timestamp ? msg.timestamp : 0.0,
+                              published_us,
+                              static_cast<uint8_t>(floorplan.units));
+            if (config_.processing.shm_ring_only) {
+                // Ring is the sole output path - skip serialization and MQTT
+                tag_state.messages++;
+                shard.stats.successful.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
         }
-        // else keep in millimeters
 
-        // Process and modify the original message to preserve nested structure
-        std::string output_json = processAndModifyMessage(payload, meter_x, meter_y, transformed_z);
-        
-        spdlog::debug("Created output JSON: {}", output_json);
+        // Windowed batch mode: append to the per-site batch instead of
+        // publishing one packet per position; workerLoop() publishes the
+        // whole batch when the window expires
+        if (batch_window_.count() > 0) {
+            appendToBatch(shard, floorplan, msg, meter_x, meter_y, transformed_z);
+            auto batch_end = std::chrono::high_resolution_clock::now();
+            shard.stats.processing_time_us.fetch_add(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    batch_end - start_time).count(),
+                std::memory_order_relaxed);
+            tag_state.messages++;
+            return;
+        }
+
+        // Serialize once, in the configured wire format, into the worker's
+        // reusable output buffer. Binary formats append in place; the JSON
+        // path still pays one dump() string per message.
+        std::string& output_payload = shard.out_buffer;
+        output_payload.clear();
+        switch (output_format_) {
+            case OutputFormat::Json:
+                if (!msg.has_dom) {
+                    // SAX fast path: append-only writer, no DOM, no dump()
+                    createJsonOutput(floorplan, msg, meter_x, meter_y,
+                                     transformed_z, output_payload);
+                } else {
+                    // Generic payloads: patch the parsed DOM and re-serialize
+                    output_payload = processAndModifyMessage(floorplan, msg,
+                                                             meter_x, meter_y, transformed_z);
+                }
+                break;
+            case OutputFormat::Cbor:
+            case OutputFormat::MsgPack:
+                createBinaryOutput(floorplan, msg, meter_x, meter_y, transformed_z,
+                                   output_payload);
+                break;
+            case OutputFormat::CompactBinary:
+                createCompactBinaryOutput(floorplan, msg, meter_x, meter_y, transformed_z,
+                                          output_payload);
+                break;
+        }
+
+        SPDLOG_DEBUG("Created output payload ({} bytes)", output_payload.size());
 
         // Calculate processing latency (transform time)
         auto transform_end = std::chrono::high_resolution_clock::now();
         auto transform_duration = std::chrono::duration_cast<std::chrono::microseconds>(transform_end - start_time);
         auto total_latency = std::chrono::duration_cast<std::chrono::microseconds>(transform_end - arrival_time);
-        total_processing_time_us_ += transform_duration.count();
+        shard.stats.processing_time_us.fetch_add(transform_duration.count(),
+                                                 std::memory_order_relaxed);
         
         // Log latency prominently
         // spdlog::info("[LATENCY] Tag {}: Transform={}μs, Total={}μs | ({:.2f}, {:.2f})mm -> ({:.3f}, {:.3f})m",
         //              tag_id, transform_duration.count(), total_latency.count(),
         //              uwb_x, uwb_y, meter_x, meter_y);
         
-        // Publish transformed data
-        std::string output_topic = config_.mqtt.dest_broker.dest_topic_prefix + tag_id;
-        spdlog::debug("Publishing to topic: {}", output_topic);
-        
-        // Capture needed data for thread - avoid capturing 'this' to prevent use-after-free
-        bool is_dual_mode = dual_mqtt_mode_;
-        auto* source_ptr = mqtt_source_handler_.get();
-        auto* dest_ptr = mqtt_dest_handler_.get();
-        auto shutdown_flag = &shutdown_requested_;
-        
-        // Publish in detached thread to avoid deadlock from MQTT callback thread
-        std::thread([is_dual_mode, source_ptr, dest_ptr, output_topic, output_json, arrival_time, shutdown_flag, this]() {
-            // Check if shutdown requested
-            if (shutdown_flag->load()) {
-                return;
-            }
-            
-            auto publish_start = std::chrono::high_resolution_clock::now();
-            
-            // Use dest_handler in dual mode, source_handler in single mode
-            MqttHandler* pub_handler = is_dual_mode ? dest_ptr : source_ptr;
-            
-            if (pub_handler && pub_handler->publish(output_topic, output_json)) {
-                auto publish_end = std::chrono::high_resolution_clock::now();
-                auto publish_latency = std::chrono::duration_cast<std::chrono::microseconds>(publish_end - publish_start);
-                auto end_to_end = std::chrono::duration_cast<std::chrono::microseconds>(publish_end - arrival_time);
-                
-                successful_transforms_++;
-                // spdlog::info("[PUBLISH] Publish={}μs, End-to-end={}μs", publish_latency.count(), end_to_end.count());
-            } else {
-                failed_transforms_++;
-                spdlog::error("Failed to publish message");
-            }
-        }).detach();
+        // Publish transformed data using the per-tag cached topic
+        tag_state.messages++;
+        const std::string& output_topic = tag_state.output_topic;
+        SPDLOG_DEBUG("Publishing to topic: {}", output_topic);
+
+        auto publish_start = std::chrono::high_resolution_clock::now();
+
+        // Use dest_handler in dual mode, source_handler in single mode
+        MqttHandler* pub_handler = dual_mqtt_mode_ ? mqtt_dest_handler_.get()
+                                                   : mqtt_source_handler_.get();
+
+        if (pub_handler && pub_handler->publish(output_topic, output_payload)) {
+            auto publish_end = std::chrono::high_resolution_clock::now();
+            auto publish_latency = std::chrono::duration_cast<std::chrono::microseconds>(publish_end - publish_start);
+            auto end_to_end = std::chrono::duration_cast<std::chrono::microseconds>(publish_end - arrival_time);
+            publish_hist_.record(publish_latency.count());
+            (void)end_to_end;
+
+            shard.stats.successful.fetch_add(1, std::memory_order_relaxed);
+            // spdlog::info("[PUBLISH] Publish={}μs, End-to-end={}μs", publish_latency.count(), end_to_end.count());
+        } else {
+            shard.stats.failed.fetch_add(1, std::memory_order_relaxed);
+            tag_state.publish_failures++;
+            spdlog::error("Failed to publish message");
+        }
 
     } catch (const std::exception& e) {
         spdlog::error("Exception in message processing: {}", e.what());
-        failed_transforms_++;
+        shard.stats.failed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool BridgeCore::parsePozyxFastPath(const std::string& payload, ParsedMessage& msg) {
+    PozyxSaxHandler handler;
+    if (!nlohmann::json::sax_parse(payload, &handler)) {
+        return false;
+    }
+
+    // Require the coordinates the generic path requires; everything else is optional
+    if (!handler.has_x || !handler.has_y) {
+        return false;
     }
+
+    // Pin down the byte spans the splice writer patches. Payloads whose
+    // shape cannot be spliced verbatim (or whose coordinates already carry
+    // the stamped keys) take the DOM path instead.
+    msg.spans = PozyxSpans{};
+    if (!scanPozyxSpans(payload, msg.spans)) {
+        return false;
+    }
+    msg.raw = &payload;
+
+    msg.uwb_x = handler.x;
+    msg.uwb_y = handler.y;
+    msg.uwb_z = handler.has_z ? handler.z : 0.0;
+    msg.tag_id = std::move(handler.tag_id);
+    msg.is_array = handler.was_array;
+    msg.timestamp = handler.timestamp;
+    msg.has_timestamp = handler.has_timestamp;
+    msg.has_dom = false;
+    return true;
 }
 
-bool BridgeCore::parseMessage(const std::string& payload,
-                             double& uwb_x, double& uwb_y, double& uwb_z,
-                             std::string& tag_id) {
+bool BridgeCore::parseMessage(const std::string& payload, ParsedMessage& msg) {
+    // Fast path: schema-specialized SAX extraction, no DOM allocations
+    if (parsePozyxFastPath(payload, msg)) {
+        SPDLOG_DEBUG("Parsed via Pozyx SAX fast path");
+        return true;
+    }
+
+    // Fallback: generic DOM parse for non-Pozyx payload shapes
     try {
-        auto j = nlohmann::json::parse(payload);
-        
+        msg.doc = nlohmann::json::parse(payload);
+        msg.has_dom = true;
+        msg.is_array = msg.doc.is_array();
+
+        double& uwb_x = msg.uwb_x;
+        double& uwb_y = msg.uwb_y;
+        double& uwb_z = msg.uwb_z;
+        std::string& tag_id = msg.tag_id;
+
         // Handle Pozyx array format: [{"coordinates": {...}, ...}]
-        if (j.is_array() && !j.empty()) {
-            j = j[0];  // Extract first element
-        }
+        // Keep the DOM intact (output stage patches the first element in place)
+        const nlohmann::json& j = (msg.doc.is_array() && !msg.doc.empty()) ? msg.doc[0] : msg.doc;
 
         // Try different possible field names for coordinates
         // Pozyx nested format: {"data": {"coordinates": {"x": ..., "y": ..., "z": ...}}}
@@ -347,14 +1161,42 @@ bool BridgeCore::parseMessage(const std::string& payload,
     }
 }
 
-bool BridgeCore::transformCoordinates(double uwb_x, double uwb_y,
-                                     double& meter_x, double& meter_y) {
+const BridgeCore::FloorplanEntry* BridgeCore::routeFloorplan(
+        const std::string& topic) const {
+    // One trie walk; the fallback entry's empty prefix is the root route,
+    // so the matcher always resolves to a valid index
+    TopicMatcher::Match match = topic_matcher_.match(topic);
+    if (match.route >= 0) {
+        return &floorplans_[static_cast<size_t>(match.route)];
+    }
+    return &floorplans_.back();  // Unreachable - the fallback always matches
+}
+
+bool BridgeCore::updateFloorplanTransform(const std::string& site_id,
+                                          const uwb_transform::TransformConfig& config) {
+    for (auto& entry : floorplans_) {
+        if (entry.site_id == site_id) {
+            entry.transformer->updateConfig(config);
+            transform_updates_.fetch_add(1, std::memory_order_relaxed);
+            spdlog::info("Floorplan '{}' transform updated", site_id);
+            return true;
+        }
+    }
+    spdlog::warn("No floorplan with site_id '{}' - update ignored", site_id);
+    return false;
+}
+
+bool BridgeCore::transformCoordinates(const FloorplanEntry& floorplan,
+                                     double uwb_x, double uwb_y, double uwb_z,
+                                     double& meter_x, double& meter_y, double& meter_z) {
     try {
-        spdlog::debug("Calling transformer_->transformToPixel({}, {})", uwb_x, uwb_y);
-        auto result = transformer_->transformToPixel(uwb_x, uwb_y);
+        SPDLOG_DEBUG("Calling transformTo3D({}, {}, {})", uwb_x, uwb_y, uwb_z);
+        auto result = floorplan.transformer->transformTo3D(uwb_x, uwb_y, uwb_z,
+                                                           floorplan.units);
         meter_x = result(0);
         meter_y = result(1);
-        spdlog::debug("Transform result: ({}, {})", meter_x, meter_y);
+        meter_z = result(2);
+        SPDLOG_DEBUG("Transform result: ({}, {}, {})", meter_x, meter_y, meter_z);
         return true;
     } catch (const std::exception& e) {
         spdlog::error("Transform error: {}", e.what());
@@ -377,13 +1219,136 @@ std::string BridgeCore::createOutputMessage(const std::string& tag_id,
     return j.dump();
 }
 
-std::string BridgeCore::processAndModifyMessage(const std::string& payload,
-                                               double transformed_x, 
-                                               double transformed_y, 
+void BridgeCore::createJsonOutput(const FloorplanEntry& floorplan,
+                                  const ParsedMessage& msg,
+                                  double x, double y, double z, std::string& out) {
+    if (msg.raw == nullptr) {
+        // No payload to splice against (defensive - parsePozyxFastPath()
+        // always sets raw): emit the minimal position shape instead
+        if (msg.is_array) {
+            out += '[';
+        }
+        appendJsonPosition(floorplan, msg, x, y, z, out);
+        if (msg.is_array) {
+            out += ']';
+        }
+        return;
+    }
+
+    const std::string& raw = *msg.raw;
+    const PozyxSpans& s = msg.spans;
+
+    // The output is the input copied byte-for-byte with up to five ordered
+    // patches applied: the x/y/z values replaced, the stamped fields
+    // inserted before the coordinates object closes, and the anchorData
+    // member (plus its separating comma) dropped
+    enum PatchKind { kX, kY, kZ, kStamp, kErase };
+    struct Patch {
+        size_t begin, end;
+        PatchKind kind;
+    };
+    std::array<Patch, 5> patches;
+    size_t n = 0;
+    patches[n++] = {s.x_begin, s.x_end, kX};
+    patches[n++] = {s.y_begin, s.y_end, kY};
+    if (s.has_z) {
+        patches[n++] = {s.z_begin, s.z_end, kZ};
+    }
+    patches[n++] = {s.coords_close, s.coords_close, kStamp};
+    if (s.has_anchor) {
+        // Extend the erased span over the member's separating comma: the
+        // one after it if anchorData is not the last member of data,
+        // otherwise the one before it (coordinates is always a sibling,
+        // so one of the two exists)
+        size_t begin = s.anchor_begin;
+        size_t end = skipJsonWs(raw, s.anchor_end);
+        if (end < raw.size() && raw[end] == ',') {
+            ++end;
+        } else {
+            end = s.anchor_end;
+            while (begin > 0 && (raw[begin - 1] == ' ' || raw[begin - 1] == '\t' ||
+                                 raw[begin - 1] == '\n' || raw[begin - 1] == '\r')) {
+                --begin;
+            }
+            if (begin > 0 && raw[begin - 1] == ',') {
+                --begin;
+            }
+        }
+        patches[n++] = {begin, end, kErase};
+    }
+    std::sort(patches.begin(), patches.begin() + n,
+              [](const Patch& a, const Patch& b) { return a.begin < b.begin; });
+
+    size_t cursor = 0;
+    for (size_t i = 0; i < n; ++i) {
+        out.append(raw, cursor, patches[i].begin - cursor);
+        switch (patches[i].kind) {
+            case kX: appendNumber(out, x); break;
+            case kY: appendNumber(out, y); break;
+            case kZ: appendNumber(out, z); break;
+            case kStamp:
+                if (!s.has_z) {
+                    out += ",\"z\":";
+                    appendNumber(out, z);
+                }
+                out += ",\"frame_id\":";
+                appendJsonString(out, floorplan.frame_id);
+                out += ",\"processing_timestamp\":";
+                appendNumber(out, getCurrentTimestampMs());
+                out += ",\"units\":";
+                appendJsonString(out, floorplan.units_str);
+                break;
+            case kErase: break;
+        }
+        cursor = patches[i].end;
+    }
+    out.append(raw, cursor, raw.size() - cursor);
+}
+
+void BridgeCore::appendJsonPosition(const FloorplanEntry& floorplan,
+                                    const ParsedMessage& msg,
+                                    double x, double y, double z, std::string& out) {
+    // Same shape and (alphabetical) field order json::dump() produced for
+    // the fast-path branch of processAndModifyMessage()
+    out += "{\"data\":{\"coordinates\":{\"frame_id\":";
+    appendJsonString(out, floorplan.frame_id);
+    out += ",\"processing_timestamp\":";
+    appendNumber(out, getCurrentTimestampMs());
+    out += ",\"units\":";
+    appendJsonString(out, floorplan.units_str);
+    out += ",\"x\":";
+    appendNumber(out, x);
+    out += ",\"y\":";
+    appendNumber(out, y);
+    out += ",\"z\":";
+    appendNumber(out, z);
+    out += "}},\"tagId\":";
+    appendJsonString(out, msg.tag_id);
+    if (msg.has_timestamp) {
+        out += ",\"timestamp\":";
+        appendNumber(out, msg.timestamp);
+    }
+    out += '}';
+}
+
+std::string BridgeCore::processAndModifyMessage(const FloorplanEntry& floorplan,
+                                               ParsedMessage& msg,
+                                               double transformed_x,
+                                               double transformed_y,
                                                double transformed_z) {
     try {
-        auto j = nlohmann::json::parse(payload);
-        
+        // Fast-path messages have no DOM: the append-only writer rebuilds
+        // the known Pozyx output shape without touching nlohmann at all
+        if (!msg.has_dom) {
+            std::string out;
+            createJsonOutput(floorplan, msg, transformed_x, transformed_y,
+                             transformed_z, out);
+            return out;
+        }
+
+        // Reuse the DOM from parseMessage() - no second parse
+        nlohmann::json& j = msg.doc;
+
         // Handle array format - modify first element
         bool is_array = j.is_array();
         auto& target = is_array ? j[0] : j;
@@ -398,9 +1363,9 @@ std::string BridgeCore::processAndModifyMessage(const std::string& payload,
             coords["x"] = transformed_x;
             coords["y"] = transformed_y;
             coords["z"] = transformed_z;
-            coords["frame_id"] = config_.transform.frame_id;
+            coords["frame_id"] = floorplan.frame_id;
             coords["processing_timestamp"] = getCurrentTimestampMs();
-            coords["units"] = config_.transform.output_units;
+            coords["units"] = floorplan.units_str;
             
             // Remove anchor data to save bandwidth
             if (target["data"].contains("anchorData")) {
@@ -410,12 +1375,7 @@ std::string BridgeCore::processAndModifyMessage(const std::string& payload,
             return j.dump();
         } else {
             // Not nested format - use createOutputMessage for backward compatibility
-            std::string tag_id = "unknown";
-            if (target.contains("tagId")) {
-                tag_id = target["tagId"].get<std::string>();
-            } else if (target.contains("tag_id")) {
-                tag_id = target["tag_id"].get<std::string>();
-            }
+            std::string tag_id = msg.tag_id.empty() ? "unknown" : msg.tag_id;
             return createOutputMessage(tag_id, transformed_x, transformed_y, transformed_z, getCurrentTimestampMs());
         }
         
@@ -427,13 +1387,158 @@ std::string BridgeCore::processAndModifyMessage(const std::string& payload,
 }
 
 
-std::string BridgeCore::extractTagIdFromTopic(const std::string& topic) {
-    // Extract last part of topic (e.g., "tags/0x1234" -> "0x1234")
-    size_t last_slash = topic.find_last_of('/');
-    if (last_slash != std::string::npos && last_slash < topic.length() - 1) {
-        return topic.substr(last_slash + 1);
+nlohmann::json BridgeCore::makePositionDoc(const FloorplanEntry& floorplan,
+                                           const ParsedMessage& msg,
+                                           double x, double y, double z) {
+    // Minimal flat document - the nested Pozyx shape exists for the JSON
+    // consumers; binary (and batch) consumers only read these fields
+    nlohmann::json j;
+    j["tag_id"] = msg.tag_id.empty() ? "unknown" : msg.tag_id;
+    j["x"] = x;
+    j["y"] = y;
+    j["z"] = z;
+    if (msg.has_timestamp) {
+        j["timestamp"] = msg.timestamp;
+    }
+    j["processing_timestamp"] = getCurrentTimestampMs();
+    j["frame_id"] = floorplan.frame_id;
+    j["units"] = floorplan.units_str;
+    return j;
+}
+
+void BridgeCore::createBinaryOutput(const FloorplanEntry& floorplan,
+                                    const ParsedMessage& msg,
+                                    double x, double y, double z, std::string& out) {
+    nlohmann::json j = makePositionDoc(floorplan, msg, x, y, z);
+
+    // The output adapter appends straight into the caller's reused buffer -
+    // no intermediate byte vector per message
+    if (output_format_ == OutputFormat::Cbor) {
+        nlohmann::json::to_cbor(j, nlohmann::detail::output_adapter<char>(out));
+    } else {
+        nlohmann::json::to_msgpack(j, nlohmann::detail::output_adapter<char>(out));
     }
-    return "unknown";
+}
+
+void BridgeCore::createCompactBinaryOutput(const FloorplanEntry& floorplan,
+                                           const ParsedMessage& msg,
+                                           double x, double y, double z, std::string& out) {
+    // Fixed-field packed layout documented in the header. All multi-byte
+    // fields are memcpy'd host-order; every platform we deploy to is
+    // little-endian x86/ARM.
+    const std::string& tag = msg.tag_id;  // Filled from the topic by processMessage() if absent
+    uint8_t tag_len = static_cast<uint8_t>(std::min<size_t>(tag.size(), 255));
+
+    out.reserve(out.size() + 4 + tag_len + 4 * sizeof(double) + sizeof(uint64_t));
+    out.push_back(static_cast<char>(0xB5));  // magic
+    out.push_back(static_cast<char>(1));     // version
+    out.push_back(static_cast<char>(floorplan.units));
+    out.push_back(static_cast<char>(tag_len));
+    out.append(tag.data(), tag_len);
+
+    auto appendRaw = [&out](const void* src, size_t len) {
+        out.append(reinterpret_cast<const char*>(src), len);
+    };
+    appendRaw(&x, sizeof(x));
+    appendRaw(&y, sizeof(y));
+    appendRaw(&z, sizeof(z));
+    double ts = msg.has_timestamp ? msg.timestamp : 0.0;
+    appendRaw(&ts, sizeof(ts));
+    uint64_t processing_ts = getCurrentTimestampMs();
+    appendRaw(&processing_ts, sizeof(processing_ts));
+}
+
+void BridgeCore::appendToBatch(WorkerShard& shard, const FloorplanEntry& floorplan,
+                               const ParsedMessage& msg,
+                               double x, double y, double z) {
+    SiteBatch& batch = shard.batches[floorplan.site_id];
+    if (batch.topic.empty()) {
+        // Built once per site per shard, like the per-tag output topics
+        batch.topic = config_.mqtt.dest_broker.dest_topic_prefix_batch +
+                      floorplan.site_id;
+    }
+
+    if (!shard.batch_open) {
+        shard.batch_open = true;
+        shard.batch_deadline = std::chrono::steady_clock::now() + batch_window_;
+    }
+
+    switch (output_format_) {
+        case OutputFormat::Json:
+            if (!batch.payload.empty()) {
+                batch.payload += ',';
+            }
+            appendJsonPosition(floorplan, msg, x, y, z, batch.payload);
+            break;
+        case OutputFormat::Cbor:
+        case OutputFormat::MsgPack:
+            batch.docs.push_back(makePositionDoc(floorplan, msg, x, y, z));
+            break;
+        case OutputFormat::CompactBinary:
+            // Records are self-delimiting (magic + tag_len), so the batch is
+            // just their concatenation
+            createCompactBinaryOutput(floorplan, msg, x, y, z, batch.payload);
+            break;
+    }
+    batch.count++;
+}
+
+void BridgeCore::flushBatches(WorkerShard& shard) {
+    if (!shard.batch_open) {
+        return;
+    }
+
+    MqttHandler* pub_handler = dual_mqtt_mode_ ? mqtt_dest_handler_.get()
+                                               : mqtt_source_handler_.get();
+
+    for (auto& [site_id, batch] : shard.batches) {
+        if (batch.count == 0) {
+            continue;
+        }
+
+        std::string& out = shard.out_buffer;
+        out.clear();
+        switch (output_format_) {
+            case OutputFormat::Json:
+                out += '[';
+                out += batch.payload;
+                out += ']';
+                break;
+            case OutputFormat::Cbor:
+                nlohmann::json::to_cbor(batch.docs,
+                                        nlohmann::detail::output_adapter<char>(out));
+                break;
+            case OutputFormat::MsgPack:
+                nlohmann::json::to_msgpack(batch.docs,
+                                           nlohmann::detail::output_adapter<char>(out));
+                break;
+            case OutputFormat::CompactBinary:
+                out += batch.payload;
+                break;
+        }
+
+        auto publish_start = std::chrono::high_resolution_clock::now();
+        if (pub_handler && pub_handler->publish(batch.topic, out)) {
+            auto publish_end = std::chrono::high_resolution_clock::now();
+            publish_hist_.record(std::chrono::duration_cast<std::chrono::microseconds>(
+                publish_end - publish_start).count());
+            shard.stats.successful.fetch_add(batch.count, std::memory_order_relaxed);
+            SPDLOG_DEBUG("Flushed batch of {} positions to {}", batch.count, batch.topic);
+        } else {
+            shard.stats.failed.fetch_add(batch.count, std::memory_order_relaxed);
+            spdlog::error("Failed to publish batch of {} positions to {}",
+                          batch.count, batch.topic);
+        }
+
+        // Keep the buffers' capacity for the next window
+        batch.payload.clear();
+        if (!batch.docs.is_null()) {
+            batch.docs.clear();
+        }
+        batch.count = 0;
+    }
+
+    shard.batch_open = false;
 }
 
 uint64_t BridgeCore::getCurrentTimestampMs() {
@@ -442,24 +1547,58 @@ uint64_t BridgeCore::getCurrentTimestampMs() {
     return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
 }
 
-BridgeStats BridgeCore::getStats() const {
+BridgeStats BridgeCore::getStats(bool reset_interval) const {
     BridgeStats stats;
-    stats.total_messages = total_messages_.load();
-    stats.successful_transforms = successful_transforms_.load();
-    stats.failed_transforms = failed_transforms_.load();
-    stats.malformed_messages = malformed_messages_.load();
+    stats.parse_latency = parse_hist_.snapshot(reset_interval);
+    stats.transform_latency = transform_hist_.snapshot(reset_interval);
+    stats.publish_latency = publish_hist_.snapshot(reset_interval);
     stats.start_time = start_time_;
-    
-    uint64_t total_time = total_processing_time_us_.load();
-    uint64_t success_count = successful_transforms_.load();
-    stats.avg_processing_time_us = success_count > 0 ? 
-        static_cast<double>(total_time) / success_count : 0.0;
-    
+
+    // Lazy aggregation: sum the per-shard counter blocks (plus counters
+    // retired from previous worker pools). The blocks are only ever
+    // incremented with relaxed atomics, so this sum is approximate across
+    // shards but exact per counter - fine for reporting.
+    uint64_t total_time = retired_stats_.processing_time_us.load(std::memory_order_relaxed);
+    stats.total_messages = retired_stats_.received.load(std::memory_order_relaxed);
+    stats.successful_transforms = retired_stats_.successful.load(std::memory_order_relaxed);
+    stats.failed_transforms = retired_stats_.failed.load(std::memory_order_relaxed);
+    stats.malformed_messages = retired_stats_.malformed.load(std::memory_order_relaxed);
+    stats.dropped_messages = retired_stats_.dropped.load(std::memory_order_relaxed);
+    stats.conflated_messages = retired_stats_.conflated.load(std::memory_order_relaxed);
+    for (const auto& shard : shards_) {
+        const ShardStats& b = shard->stats;
+        stats.total_messages += b.received.load(std::memory_order_relaxed);
+        stats.successful_transforms += b.successful.load(std::memory_order_relaxed);
+        stats.failed_transforms += b.failed.load(std::memory_order_relaxed);
+        stats.malformed_messages += b.malformed.load(std::memory_order_relaxed);
+        stats.dropped_messages += b.dropped.load(std::memory_order_relaxed);
+        stats.conflated_messages += b.conflated.load(std::memory_order_relaxed);
+        total_time += b.processing_time_us.load(std::memory_order_relaxed);
+    }
+
+    stats.avg_processing_time_us = stats.successful_transforms > 0 ?
+        static_cast<double>(total_time) / stats.successful_transforms : 0.0;
+
     return stats;
 }
 
-void BridgeCore::printStats() const {
-    auto stats = getStats();
+void BridgeCore::retireShardStats() {
+    for (const auto& shard : shards_) {
+        const ShardStats& b = shard->stats;
+        retired_stats_.received += b.received.load(std::memory_order_relaxed);
+        retired_stats_.successful += b.successful.load(std::memory_order_relaxed);
+        retired_stats_.failed += b.failed.load(std::memory_order_relaxed);
+        retired_stats_.malformed += b.malformed.load(std::memory_order_relaxed);
+        retired_stats_.dropped += b.dropped.load(std::memory_order_relaxed);
+        retired_stats_.conflated += b.conflated.load(std::memory_order_relaxed);
+        retired_stats_.processed += b.processed.load(std::memory_order_relaxed);
+        retired_stats_.processing_time_us +=
+            b.processing_time_us.load(std::memory_order_relaxed);
+    }
+}
+
+void BridgeCore::printStats(bool reset_interval) const {
+    auto stats = getStats(reset_interval);
     auto now = std::chrono::system_clock::now();
     auto uptime = std::chrono::duration_cast<std::chrono::seconds>(now - stats.start_time);
     
@@ -471,6 +1610,8 @@ void BridgeCore::printStats() const {
     spdlog::info("Successful:           {}", stats.successful_transforms);
     spdlog::info("Failed:               {}", stats.failed_transforms);
     spdlog::info("Malformed:            {}", stats.malformed_messages);
+    spdlog::info("Dropped (queue full): {}", stats.dropped_messages);
+    spdlog::info("Conflated:            {}", stats.conflated_messages);
     
     if (stats.successful_transforms > 0) {
         double success_rate = 100.0 * stats.successful_transforms / stats.total_messages;
@@ -482,8 +1623,146 @@ void BridgeCore::printStats() const {
             spdlog::info("Throughput:           {:.2f} msg/sec", throughput);
         }
     }
-    
+
+    // Per-stage latency percentiles (interval since last reset when enabled)
+    auto logHistogram = [](const char* stage, const LatencyHistogram::Snapshot& s) {
+        if (s.count == 0) {
+            return;
+        }
+        spdlog::info("{} p50={}us p90={}us p99={}us max={}us (n={})",
+                     stage, s.p50_us, s.p90_us, s.p99_us, s.max_us, s.count);
+    };
+    logHistogram("Parse latency:       ", stats.parse_latency);
+    logHistogram("Transform latency:   ", stats.transform_latency);
+    logHistogram("Publish latency:     ", stats.publish_latency);
+
     spdlog::info("=================================================");
 }
 
+
+std::string BridgeCore::renderMetrics() const {
+    std::ostringstream out;
+
+    auto counter = [&out](const char* name, const char* help, uint64_t value) {
+        out << "# HELP " << name << ' ' << help << "\n"
+            << "# TYPE " << name << " counter\n"
+            << name << ' ' << value << "\n";
+    };
+    auto gauge = [&out](const char* name, const char* help, double value) {
+        out << "# HELP " << name << ' ' << help << "\n"
+            << "# TYPE " << name << " gauge\n"
+            << name << ' ' << value << "\n";
+    };
+    // Latency snapshots come from the lock-free histograms, exposed as
+    // summaries (quantiles + count); max goes out as a companion gauge
+    auto summary = [&out](const char* name, const char* help,
+                          const LatencyHistogram::Snapshot& s) {
+        out << "# HELP " << name << ' ' << help << "\n"
+            << "# TYPE " << name << " summary\n"
+            << name << "{quantile=\"0.5\"} " << s.p50_us << "\n"
+            << name << "{quantile=\"0.9\"} " << s.p90_us << "\n"
+            << name << "{quantile=\"0.99\"} " << s.p99_us << "\n"
+            << name << "_count " << s.count << "\n"
+            << name << "_max " << s.max_us << "\n";
+    };
+
+    auto uptime = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now() - start_time_);
+    gauge("uwb_bridge_uptime_seconds", "Seconds since the bridge started",
+          static_cast<double>(uptime.count()));
+
+    // One lazy aggregation pass over the per-shard counter blocks
+    const BridgeStats stats = getStats();
+    counter("uwb_bridge_messages_received_total",
+            "Messages received from the source broker", stats.total_messages);
+    counter("uwb_bridge_transforms_success_total",
+            "Messages transformed and published", stats.successful_transforms);
+    counter("uwb_bridge_transforms_failed_total",
+            "Messages that failed transform or publish", stats.failed_transforms);
+    counter("uwb_bridge_messages_malformed_total",
+            "Messages rejected by the parser", stats.malformed_messages);
+    counter("uwb_bridge_messages_dropped_total",
+            "Messages dropped on full shard queues", stats.dropped_messages);
+    counter("uwb_bridge_messages_conflated_total",
+            "Pending positions replaced by a newer one", stats.conflated_messages);
+    counter("uwb_bridge_transform_config_updates_total",
+            "Runtime transform config swaps (Firestore listener)",
+            transform_updates_);
+
+    summary("uwb_bridge_parse_latency_microseconds",
+            "Payload parse stage latency", stats.parse_latency);
+    summary("uwb_bridge_transform_latency_microseconds",
+            "Coordinate transform stage latency", stats.transform_latency);
+    summary("uwb_bridge_publish_latency_microseconds",
+            "Publish call latency", stats.publish_latency);
+
+    // Per-shard throughput and depth. Queue depth is read without the shard
+    // mutex: the size is a single word and a stale value is fine for a
+    // scrape, while taking the lock could stall a worker mid-burst.
+    out << "# HELP uwb_bridge_shard_processed_total Messages processed per worker shard\n"
+        << "# TYPE uwb_bridge_shard_processed_total counter\n";
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        out << "uwb_bridge_shard_processed_total{shard=\"" << i << "\"} "
+            << shards_[i]->stats.processed.load(std::memory_order_relaxed) << "\n";
+    }
+    out << "# HELP uwb_bridge_shard_queue_depth Approximate queued messages per worker shard\n"
+        << "# TYPE uwb_bridge_shard_queue_depth gauge\n";
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        out << "uwb_bridge_shard_queue_depth{shard=\"" << i << "\"} "
+            << shards_[i]->queue.size() << "\n";
+    }
+
+    // MQTT connection and delivery accounting
+    auto brokerMetrics = [&out](const char* role, const MqttHandler* handler) {
+        if (!handler) {
+            return;
+        }
+        out << "uwb_bridge_mqtt_connected{broker=\"" << role << "\"} "
+            << (handler->isConnected() ? 1 : 0) << "\n";
+        out << "uwb_bridge_mqtt_connection_lost_total{broker=\"" << role << "\"} "
+            << handler->connectionsLost() << "\n";
+    };
+    out << "# HELP uwb_bridge_mqtt_connected Broker connection state (1 = connected)\n"
+        << "# TYPE uwb_bridge_mqtt_connected gauge\n"
+        << "# HELP uwb_bridge_mqtt_connection_lost_total Broker connection losses\n"
+        << "# TYPE uwb_bridge_mqtt_connection_lost_total counter\n";
+    brokerMetrics("source", mqtt_source_handler_.get());
+    if (dual_mqtt_mode_) {
+        brokerMetrics("dest", mqtt_dest_handler_.get());
+    }
+
+    const MqttHandler* pub_handler = dual_mqtt_mode_ ? mqtt_dest_handler_.get()
+                                                     : mqtt_source_handler_.get();
+    if (pub_handler) {
+        auto ps = const_cast<MqttHandler*>(pub_handler)->getPublishStats();
+        counter("uwb_bridge_mqtt_published_total", "Publishes initiated", ps.published);
+        counter("uwb_bridge_mqtt_delivered_total", "Publishes confirmed by the broker",
+                ps.delivered);
+        counter("uwb_bridge_mqtt_backpressured_total",
+                "Publishes rejected by the in-flight cap", ps.backpressured);
+        gauge("uwb_bridge_mqtt_in_flight", "Currently unconfirmed QoS>0 publishes",
+              ps.in_flight);
+        summary("uwb_bridge_mqtt_delivery_latency_microseconds",
+                "Publish-to-broker-confirm latency", ps.delivery_latency);
+        counter("uwb_bridge_spool_spooled_total",
+                "Publishes buffered by the offline spool", ps.spool.spooled);
+        counter("uwb_bridge_spool_replayed_total",
+                "Spooled publishes delivered after reconnect", ps.spool_replayed);
+        counter("uwb_bridge_spool_dropped_total",
+                "Spooled publishes evicted without replacement", ps.spool.dropped);
+        counter("uwb_bridge_spool_expired_total",
+                "Spooled publishes discarded for exceeding max age", ps.spool.expired);
+        gauge("uwb_bridge_spool_pending",
+              "Spooled publishes awaiting replay", ps.spool.pending);
+    }
+
+    if (shm_ring_.isOpen()) {
+        counter("uwb_bridge_shm_ring_records_total",
+                "Positions published into the shared-memory ring",
+                shm_ring_.recordCount());
+    }
+
+    return out.str();
+}
+
 } // namespace uwb_bridge
@@ -0,0 +1,258 @@
+#include "CaptureLog.hpp"
+#include <spdlog/spdlog.h>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace uwb_bridge {
+
+namespace {
+
+constexpr char kMagic[8] = {'U', 'W', 'B', 'C', 'A', 'P', '0', '1'};
+constexpr size_t kMagicSize = sizeof(kMagic);
+
+// Grow the capture file in 64 MiB steps so steady-state appends never
+// touch the filesystem metadata
+constexpr size_t kGrowChunk = 64 * 1024 * 1024;
+
+// Fixed-size record prefix: timestamp + topic/payload lengths
+constexpr size_t kRecordHeader = sizeof(uint64_t) + 2 * sizeof(uint32_t);
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// CaptureWriter
+// ---------------------------------------------------------------------------
+
+CaptureWriter::~CaptureWriter() {
+    close();
+}
+
+bool CaptureWriter::open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (data_) {
+        spdlog::error("Capture log already open: {}", path_);
+        return false;
+    }
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        spdlog::error("Failed to create capture log {}: {}", path, strerror(errno));
+        return false;
+    }
+
+    if (ftruncate(fd_, kGrowChunk) != 0) {
+        spdlog::error("Failed to size capture log {}: {}", path, strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, kGrowChunk, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        spdlog::error("Failed to map capture log {}: {}", path, strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    data_ = static_cast<char*>(mapping);
+    mapped_size_ = kGrowChunk;
+    path_ = path;
+    record_count_ = 0;
+
+    std::memcpy(data_, kMagic, kMagicSize);
+    write_offset_ = kMagicSize;
+
+    spdlog::info("Capture log opened: {}", path);
+    return true;
+}
+
+bool CaptureWriter::ensureCapacity(size_t bytes) {
+    if (write_offset_ + bytes <= mapped_size_) {
+        return true;
+    }
+
+    size_t new_size = mapped_size_;
+    while (write_offset_ + bytes > new_size) {
+        new_size += kGrowChunk;
+    }
+
+    munmap(data_, mapped_size_);
+    data_ = nullptr;
+
+    if (ftruncate(fd_, new_size) != 0) {
+        spdlog::error("Failed to grow capture log {}: {}", path_, strerror(errno));
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, new_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        spdlog::error("Failed to remap capture log {}: {}", path_, strerror(errno));
+        return false;
+    }
+
+    data_ = static_cast<char*>(mapping);
+    mapped_size_ = new_size;
+    return true;
+}
+
+bool CaptureWriter::append(const std::string& topic, const std::string& payload,
+                           uint64_t timestamp_us) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!data_) {
+        return false;
+    }
+
+    const uint32_t topic_len = static_cast<uint32_t>(topic.size());
+    const uint32_t payload_len = static_cast<uint32_t>(payload.size());
+    const size_t record_size = kRecordHeader + topic_len + payload_len;
+
+    if (!ensureCapacity(record_size)) {
+        return false;
+    }
+
+    char* p = data_ + write_offset_;
+    std::memcpy(p, &timestamp_us, sizeof(timestamp_us)); p += sizeof(timestamp_us);
+    std::memcpy(p, &topic_len, sizeof(topic_len));       p += sizeof(topic_len);
+    std::memcpy(p, &payload_len, sizeof(payload_len));   p += sizeof(payload_len);
+    std::memcpy(p, topic.data(), topic_len);             p += topic_len;
+    std::memcpy(p, payload.data(), payload_len);
+
+    write_offset_ += record_size;
+    record_count_++;
+    return true;
+}
+
+void CaptureWriter::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (data_) {
+        munmap(data_, mapped_size_);
+        data_ = nullptr;
+    }
+
+    // Trim the preallocated tail down to the bytes actually written. Guarded
+    // on the fd alone: a failed grow in ensureCapacity() drops the mapping
+    // but leaves the fd open, and the records written before the failure
+    // still deserve the trim (and the descriptor must not leak)
+    if (fd_ >= 0) {
+        if (ftruncate(fd_, static_cast<off_t>(write_offset_)) != 0) {
+            spdlog::warn("Failed to trim capture log {}: {}", path_, strerror(errno));
+        }
+        ::close(fd_);
+        fd_ = -1;
+
+        spdlog::info("Capture log closed: {} ({} messages, {} bytes)",
+                     path_, record_count_, write_offset_);
+    }
+    mapped_size_ = 0;
+    write_offset_ = 0;
+}
+
+// ---------------------------------------------------------------------------
+// CaptureReader
+// ---------------------------------------------------------------------------
+
+CaptureReader::~CaptureReader() {
+    close();
+}
+
+bool CaptureReader::open(const std::string& path) {
+    if (data_) {
+        spdlog::error("Capture log already open for reading");
+        return false;
+    }
+
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        spdlog::error("Failed to open capture log {}: {}", path, strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        spdlog::error("Failed to stat capture log {}: {}", path, strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+
+    if (size_ < kMagicSize) {
+        spdlog::error("Capture log {} too small ({} bytes)", path, size_);
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        spdlog::error("Failed to map capture log {}: {}", path, strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    data_ = static_cast<const char*>(mapping);
+
+    if (std::memcmp(data_, kMagic, kMagicSize) != 0) {
+        spdlog::error("Capture log {} has invalid header", path);
+        close();
+        return false;
+    }
+
+    read_offset_ = kMagicSize;
+    return true;
+}
+
+bool CaptureReader::next(Record& out) {
+    if (!data_ || read_offset_ + kRecordHeader > size_) {
+        return false;
+    }
+
+    const char* p = data_ + read_offset_;
+    uint64_t timestamp_us;
+    uint32_t topic_len, payload_len;
+    std::memcpy(&timestamp_us, p, sizeof(timestamp_us)); p += sizeof(timestamp_us);
+    std::memcpy(&topic_len, p, sizeof(topic_len));       p += sizeof(topic_len);
+    std::memcpy(&payload_len, p, sizeof(payload_len));   p += sizeof(payload_len);
+
+    const size_t record_size = kRecordHeader + topic_len + payload_len;
+    if (read_offset_ + record_size > size_) {
+        // Truncated trailing record (e.g. capture cut by a crash) - stop here
+        return false;
+    }
+
+    out.timestamp_us = timestamp_us;
+    out.topic = p;
+    out.topic_len = topic_len;
+    out.payload = p + topic_len;
+    out.payload_len = payload_len;
+
+    read_offset_ += record_size;
+    return true;
+}
+
+void CaptureReader::rewind() {
+    if (data_) {
+        read_offset_ = kMagicSize;
+    }
+}
+
+void CaptureReader::close() {
+    if (data_) {
+        munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    size_ = 0;
+    read_offset_ = 0;
+}
+
+} // namespace uwb_bridge
@@ -1,4 +1,5 @@
 #include "ConfigLoader.hpp"
+#include <cstdio>
 #include <fstream>
 #include <stdexcept>
 #include <spdlog/spdlog.h>
@@ -35,11 +36,42 @@ AppConfig ConfigLoader::loadFromFile(const std::string& config_path) {
         throw std::runtime_error("Missing 'transform' section in configuration");
     }
 
+    // Parse additional floorplans (optional; transform above stays the fallback)
+    if (j.contains("floorplans")) {
+        for (const auto& fp : j["floorplans"]) {
+            FloorplanConfig floorplan;
+            if (!fp.contains("site_id") || !fp.contains("topic_prefix") ||
+                !fp.contains("transform")) {
+                throw std::runtime_error(
+                    "Each floorplan needs site_id, topic_prefix and transform");
+            }
+            floorplan.site_id = fp["site_id"].get<std::string>();
+            floorplan.topic_prefix = fp["topic_prefix"].get<std::string>();
+            floorplan.transform = parseTransformConfig(fp["transform"]);
+            config.floorplans.push_back(std::move(floorplan));
+        }
+        spdlog::info("Loaded {} additional floorplan(s)", config.floorplans.size());
+    }
+
+    // Parse processing configuration (optional section with defaults)
+    if (j.contains("processing")) {
+        const auto& p = j["processing"];
+        config.processing.worker_threads = p.value("worker_threads", 4);
+        config.processing.queue_capacity = p.value("queue_capacity", 1024);
+        config.processing.conflation = p.value("conflation", true);
+        config.processing.capture_file = p.value("capture_file", "");
+        config.processing.shm_ring_name = p.value("shm_ring_name", "");
+        config.processing.shm_ring_capacity = p.value("shm_ring_capacity", 4096);
+        config.processing.shm_ring_only = p.value("shm_ring_only", false);
+        config.processing.batch_window_ms = p.value("batch_window_ms", 0);
+    }
+
     // Parse logging configuration (with defaults)
     config.log_level = j.value("log_level", "info");
     config.log_file = j.value("log_file", "");
     config.log_rotation_size_mb = j.value("log_rotation_size_mb", 10);
     config.log_rotation_count = j.value("log_rotation_count", 3);
+    config.metrics_port = j.value("metrics_port", 0);
 
     // Validate configuration
     validate(config);
@@ -48,6 +80,103 @@ AppConfig ConfigLoader::loadFromFile(const std::string& config_path) {
     return config;
 }
 
+namespace {
+
+nlohmann::json brokerToJson(const MqttConfig& c) {
+    nlohmann::json j;
+    j["broker_address"] = c.broker_address;
+    j["port"] = c.port;
+    j["client_id"] = c.client_id;
+    j["username"] = c.username;
+    j["password"] = c.password;
+    j["source_topic"] = c.source_topic;
+    j["dest_topic_prefix"] = c.dest_topic_prefix;
+    j["qos"] = c.qos;
+    j["keepalive_interval"] = c.keepalive_interval;
+    j["clean_session"] = c.clean_session;
+    j["use_ssl"] = c.use_ssl;
+    j["use_websockets"] = c.use_websockets;
+    j["ws_path"] = c.ws_path;
+    j["max_in_flight"] = c.max_in_flight;
+    j["dest_topic_prefix_binary"] = c.dest_topic_prefix_binary;
+    j["dest_topic_prefix_batch"] = c.dest_topic_prefix_batch;
+    j["spool_memory_kb"] = c.spool_memory_kb;
+    j["spool_file"] = c.spool_file;
+    j["spool_file_mb"] = c.spool_file_mb;
+    j["spool_max_age_ms"] = c.spool_max_age_ms;
+    j["spool_drain_rate"] = c.spool_drain_rate;
+    return j;
+}
+
+nlohmann::json transformToJson(const TransformConfig& c) {
+    nlohmann::json j;
+    j["origin_x"] = c.origin_x;
+    j["origin_y"] = c.origin_y;
+    j["scale"] = c.scale;
+    j["rotation_rad"] = c.rotation_rad;
+    j["x_flipped"] = c.x_flipped;
+    j["y_flipped"] = c.y_flipped;
+    j["z_offset"] = c.z_offset;
+    j["z_scale"] = c.z_scale;
+    j["frame_id"] = c.frame_id;
+    j["output_units"] = c.output_units;
+    j["output_format"] = c.output_format;
+    return j;
+}
+
+} // namespace
+
+void ConfigLoader::saveToFile(const AppConfig& config, const std::string& config_path) {
+    nlohmann::json j;
+
+    if (config.mqtt.dual_mode) {
+        j["mqtt"]["source_broker"] = brokerToJson(config.mqtt.source_broker);
+        j["mqtt"]["dest_broker"] = brokerToJson(config.mqtt.dest_broker);
+    } else {
+        j["mqtt"] = brokerToJson(config.mqtt.source_broker);
+    }
+
+    j["transform"] = transformToJson(config.transform);
+
+    for (const auto& fp : config.floorplans) {
+        nlohmann::json entry;
+        entry["site_id"] = fp.site_id;
+        entry["topic_prefix"] = fp.topic_prefix;
+        entry["transform"] = transformToJson(fp.transform);
+        j["floorplans"].push_back(std::move(entry));
+    }
+
+    j["processing"]["worker_threads"] = config.processing.worker_threads;
+    j["processing"]["queue_capacity"] = config.processing.queue_capacity;
+    j["processing"]["conflation"] = config.processing.conflation;
+    j["processing"]["capture_file"] = config.processing.capture_file;
+    j["processing"]["shm_ring_name"] = config.processing.shm_ring_name;
+    j["processing"]["shm_ring_capacity"] = config.processing.shm_ring_capacity;
+    j["processing"]["shm_ring_only"] = config.processing.shm_ring_only;
+    j["processing"]["batch_window_ms"] = config.processing.batch_window_ms;
+
+    j["log_level"] = config.log_level;
+    j["log_file"] = config.log_file;
+    j["log_rotation_size_mb"] = config.log_rotation_size_mb;
+    j["log_rotation_count"] = config.log_rotation_count;
+    j["metrics_port"] = config.metrics_port;
+
+    // Atomic replace: write a temp file, then rename over the destination
+    const std::string tmp_path = config_path + ".tmp";
+    {
+        std::ofstream out(tmp_path);
+        if (!out.is_open()) {
+            throw std::runtime_error("Failed to write config file: " + tmp_path);
+        }
+        out << j.dump(2) << "\n";
+    }
+    if (std::rename(tmp_path.c_str(), config_path.c_str()) != 0) {
+        throw std::runtime_error("Failed to replace config file: " + config_path);
+    }
+
+    spdlog::info("Configuration saved to: {}", config_path);
+}
+
 DualMqttConfig ConfigLoader::parseMqttConfig(const nlohmann::json& j) {
     DualMqttConfig config;
     
@@ -96,6 +225,14 @@ MqttConfig ConfigLoader::parseSingleBrokerConfig(const nlohmann::json& j) {
     config.port = j.value("port", 0);
     config.use_websockets = j.value("use_websockets", false);
     config.ws_path = j.value("ws_path", "/mqtt");
+    config.max_in_flight = j.value("max_in_flight", 64);
+    config.dest_topic_prefix_binary = j.value("dest_topic_prefix_binary", "processed-bin/");
+    config.dest_topic_prefix_batch = j.value("dest_topic_prefix_batch", "processed-batch/");
+    config.spool_memory_kb = j.value("spool_memory_kb", 0);
+    config.spool_file = j.value("spool_file", "");
+    config.spool_file_mb = j.value("spool_file_mb", 64);
+    config.spool_max_age_ms = j.value("spool_max_age_ms", 60000);
+    config.spool_drain_rate = j.value("spool_drain_rate", 500);
 
     return config;
 }
@@ -115,8 +252,11 @@ TransformConfig ConfigLoader::parseTransformConfig(const nlohmann::json& j) {
     config.rotation_rad = j["rotation_rad"].get<double>();
     config.x_flipped = j.value("x_flipped", false);
     config.y_flipped = j.value("y_flipped", false);
+    config.z_offset = j.value("z_offset", 0.0);
+    config.z_scale = j.value("z_scale", 1.0);
     config.frame_id = j.value("frame_id", "floorplan_pixel_frame");
     config.output_units = j.value("output_units", "meters");
+    config.output_format = j.value("output_format", "json");
 
     return config;
 }
@@ -146,11 +286,80 @@ bool ConfigLoader::validate(const AppConfig& config) {
         }
     }
 
+    // Validate processing configuration
+    if (config.processing.worker_threads < 1) {
+        throw std::invalid_argument("Processing worker_threads must be at least 1");
+    }
+
+    if (config.processing.queue_capacity < 1) {
+        throw std::invalid_argument("Processing queue_capacity must be at least 1");
+    }
+
+    if (!config.processing.shm_ring_name.empty()) {
+        if (config.processing.shm_ring_name[0] != '/') {
+            throw std::invalid_argument("Processing shm_ring_name must start with '/'");
+        }
+        if (config.processing.shm_ring_capacity < 1) {
+            throw std::invalid_argument("Processing shm_ring_capacity must be at least 1");
+        }
+    }
+    if (config.processing.shm_ring_only && config.processing.shm_ring_name.empty()) {
+        throw std::invalid_argument("Processing shm_ring_only requires shm_ring_name");
+    }
+    if (config.processing.batch_window_ms < 0) {
+        throw std::invalid_argument("Processing batch_window_ms cannot be negative");
+    }
+
+    // Validate offline spool configuration on both brokers
+    for (const MqttConfig* broker : {&config.mqtt.source_broker, &config.mqtt.dest_broker}) {
+        if (broker->spool_memory_kb < 0) {
+            throw std::invalid_argument("MQTT spool_memory_kb cannot be negative");
+        }
+        if (!broker->spool_file.empty() && broker->spool_file_mb < 1) {
+            throw std::invalid_argument("MQTT spool_file_mb must be at least 1");
+        }
+        if (broker->spool_max_age_ms < 1) {
+            throw std::invalid_argument("MQTT spool_max_age_ms must be positive");
+        }
+        if (broker->spool_drain_rate < 0) {
+            throw std::invalid_argument("MQTT spool_drain_rate cannot be negative");
+        }
+    }
+
     // Validate transform configuration
     if (config.transform.scale == 0.0) {
         throw std::invalid_argument("Transform scale cannot be zero");
     }
 
+    // Validate floorplans (unique site IDs, non-empty routing prefixes)
+    for (size_t i = 0; i < config.floorplans.size(); ++i) {
+        const auto& fp = config.floorplans[i];
+        if (fp.site_id.empty()) {
+            throw std::invalid_argument("Floorplan site_id cannot be empty");
+        }
+        if (fp.topic_prefix.empty()) {
+            throw std::invalid_argument("Floorplan topic_prefix cannot be empty");
+        }
+        if (fp.transform.scale == 0.0) {
+            throw std::invalid_argument("Floorplan '" + fp.site_id +
+                                        "' transform scale cannot be zero");
+        }
+        for (size_t k = 0; k < i; ++k) {
+            if (config.floorplans[k].site_id == fp.site_id) {
+                throw std::invalid_argument("Duplicate floorplan site_id: " + fp.site_id);
+            }
+        }
+    }
+
+    // Validate output format
+    const std::vector<std::string> valid_formats = {
+        "json", "cbor", "msgpack", "compact"
+    };
+    if (std::find(valid_formats.begin(), valid_formats.end(),
+                  config.transform.output_format) == valid_formats.end()) {
+        throw std::invalid_argument("Invalid output format: " + config.transform.output_format);
+    }
+
     // Validate logging configuration
     const std::vector<std::string> valid_levels = {
         "trace", "debug", "info", "warn", "error", "critical", "off"
@@ -159,6 +368,10 @@ bool ConfigLoader::validate(const AppConfig& config) {
         throw std::invalid_argument("Invalid log level: " + config.log_level);
     }
 
+    if (config.metrics_port < 0 || config.metrics_port > 65535) {
+        throw std::invalid_argument("metrics_port must be in [0, 65535]");
+    }
+
     return true;
 }
 
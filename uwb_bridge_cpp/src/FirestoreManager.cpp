@@ -10,6 +10,26 @@
 
 namespace uwb_bridge {
 
+bool FirestoreManager::loadCachedConfig(AppConfig& config,
+                                        const std::string& cache_path) {
+    std::ifstream probe(cache_path);
+    if (!probe.is_open()) {
+        spdlog::info("No local config cache at {}", cache_path);
+        return false;
+    }
+    probe.close();
+
+    try {
+        config = ConfigLoader::loadFromFile(cache_path);
+        spdlog::info("Loaded configuration from local cache: {}", cache_path);
+        return true;
+    } catch (const std::exception& e) {
+        spdlog::warn("Local config cache {} is invalid ({}), ignoring",
+                     cache_path, e.what());
+        return false;
+    }
+}
+
 FirestoreManager::FirestoreManager()
     : app_(nullptr),
       auth_(nullptr),
@@ -256,6 +276,15 @@ std::future<AppConfig> FirestoreManager::fetchAppConfig() {
             try {
                 AppConfig config = parseAppConfig(*snapshot);
                 spdlog::info("Successfully fetched AppConfig from Firestore");
+
+                // Write-through cache: the next startup can begin serving
+                // from this file without waiting on Firestore
+                try {
+                    ConfigLoader::saveToFile(config, kDefaultCachePath);
+                } catch (const std::exception& e) {
+                    spdlog::warn("Failed to update local config cache: {}", e.what());
+                }
+
                 promise->set_value(config);
             } catch (const std::exception& e) {
                 spdlog::error("Failed to parse AppConfig: {}", e.what());
@@ -279,7 +308,14 @@ bool FirestoreManager::startTransformListener(std::shared_ptr<uwb_transform::Flo
     }
     
     spdlog::info("Starting real-time listener for TransformConfig...");
-    
+
+    // Start the applier before the listener so no update can be missed
+    stopTransformApplier();
+    applier_stop_ = false;
+    transform_applier_ = std::thread(&FirestoreManager::transformApplierLoop,
+                                     this, transformer);
+
+
     // Get reference to the pozyx document in your Firestore structure
     // Path: setups/&GSP&Office&29607/environment/pozyx
     auto doc_ref = db_->Collection("setups")
@@ -289,7 +325,7 @@ bool FirestoreManager::startTransformListener(std::shared_ptr<uwb_transform::Flo
     
     // Add OnSnapshot listener for real-time updates
     transform_listener_ = doc_ref.AddSnapshotListener(
-        [this, transformer](const firebase::firestore::DocumentSnapshot& snapshot,
+        [this](const firebase::firestore::DocumentSnapshot& snapshot,
                            firebase::firestore::Error error,
                            const std::string& error_message) {
             
@@ -315,15 +351,24 @@ bool FirestoreManager::startTransformListener(std::shared_ptr<uwb_transform::Flo
                 transform_config.rotation_rad = new_config.rotation_rad;
                 transform_config.x_flipped = new_config.x_flipped;
                 transform_config.y_flipped = new_config.y_flipped;
-                
-                // Thread-safe update to the transformer
-                transformer->updateConfig(transform_config);
-                
-                spdlog::info("Updated transform matrix from Firestore");
-                spdlog::debug("New config - Origin: ({}, {}), Scale: {}, Rotation: {} rad",
+                transform_config.z_offset = new_config.z_offset;
+                transform_config.z_scale = new_config.z_scale;
+
+                // Deposit in the coalescing slot and return - the applier
+                // thread takes the transformer's writer lock at a capped
+                // rate, so a burst of snapshots (calibration drag in the
+                // admin UI) never stalls transform readers per snapshot
+                {
+                    std::lock_guard<std::mutex> lock(pending_mutex_);
+                    pending_config_ = transform_config;
+                    pending_version_++;
+                }
+                pending_cv_.notify_one();
+
+                SPDLOG_DEBUG("Queued transform update - Origin: ({}, {}), Scale: {}, Rotation: {} rad",
                              transform_config.origin_x, transform_config.origin_y,
                              transform_config.scale, transform_config.rotation_rad);
-                
+
             } catch (const std::exception& e) {
                 spdlog::error("Failed to parse TransformConfig update: {}", e.what());
             }
@@ -337,6 +382,47 @@ bool FirestoreManager::startTransformListener(std::shared_ptr<uwb_transform::Flo
 void FirestoreManager::stopTransformListener() {
     spdlog::info("Stopping TransformConfig listener...");
     transform_listener_.Remove();
+    stopTransformApplier();
+}
+
+void FirestoreManager::transformApplierLoop(
+    std::shared_ptr<uwb_transform::FloorplanTransformer> transformer) {
+    uint64_t applied_version = 0;
+
+    std::unique_lock<std::mutex> lock(pending_mutex_);
+    while (true) {
+        pending_cv_.wait(lock, [this, applied_version] {
+            return applier_stop_ || pending_version_ != applied_version;
+        });
+        if (applier_stop_) {
+            return;
+        }
+
+        // Always skip straight to the newest value
+        const uwb_transform::TransformConfig config = pending_config_;
+        applied_version = pending_version_;
+        lock.unlock();
+
+        transformer->updateConfig(config);
+        spdlog::info("Applied transform update from Firestore");
+
+        // Rate cap: snapshots arriving during this pause coalesce in the
+        // slot and the next apply picks up only the final value
+        std::this_thread::sleep_for(
+            std::chrono::milliseconds(TRANSFORM_APPLY_INTERVAL_MS));
+        lock.lock();
+    }
+}
+
+void FirestoreManager::stopTransformApplier() {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        applier_stop_ = true;
+    }
+    pending_cv_.notify_all();
+    if (transform_applier_.joinable()) {
+        transform_applier_.join();
+    }
 }
 
 AppConfig FirestoreManager::parseAppConfig(const firebase::firestore::DocumentSnapshot& snapshot) {
@@ -414,7 +500,15 @@ uwb_bridge::TransformConfig FirestoreManager::parseTransformConfig(
         
         config.x_flipped = (x_flip_val == 1);
         config.y_flipped = (y_flip_val == -1);  // -1 means flipped for y
-        
+
+        // Optional Z calibration (older documents won't have these)
+        auto z_offset_it = transform_map.find("z_offset");
+        config.z_offset = (z_offset_it != transform_map.end())
+                              ? z_offset_it->second.double_value() : 0.0;
+        auto z_scale_it = transform_map.find("z_scale");
+        config.z_scale = (z_scale_it != transform_map.end())
+                             ? z_scale_it->second.double_value() : 1.0;
+
         // Set defaults for fields not in your DB
         config.frame_id = "floorplan_pixel_frame";
         config.output_units = "meters";
@@ -0,0 +1,130 @@
+#include "MetricsServer.hpp"
+#include <spdlog/spdlog.h>
+#include <cerrno>
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace uwb_bridge {
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start(int port, RenderFn render) {
+    if (running_) {
+        return false;
+    }
+    render_ = std::move(render);
+
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        spdlog::error("Metrics server: socket() failed: {}", std::strerror(errno));
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        spdlog::error("Metrics server: failed to bind port {}: {}",
+                      port, std::strerror(errno));
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    if (listen(listen_fd_, 4) != 0) {
+        spdlog::error("Metrics server: listen() failed: {}", std::strerror(errno));
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    running_ = true;
+    thread_ = std::thread(&MetricsServer::serveLoop, this);
+    spdlog::info("Metrics server listening on port {} (/metrics)", port);
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+    }
+}
+
+void MetricsServer::serveLoop() {
+    while (running_) {
+        // Poll with a timeout so stop() is noticed without needing to poke
+        // the socket from another thread
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        int ready = poll(&pfd, 1, 250);
+        if (ready <= 0) {
+            continue;
+        }
+
+        int client_fd = accept(listen_fd_, nullptr, nullptr);
+        if (client_fd < 0) {
+            continue;
+        }
+        handleConnection(client_fd);
+        ::close(client_fd);
+    }
+}
+
+void MetricsServer::handleConnection(int client_fd) {
+    // One read is enough for the request line + headers of a scrape request;
+    // anything larger is not a Prometheus client
+    char buf[2048];
+    ssize_t n = recv(client_fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) {
+        return;
+    }
+    buf[n] = '\0';
+
+    const bool is_metrics = std::strncmp(buf, "GET /metrics", 12) == 0;
+
+    std::string response;
+    if (is_metrics) {
+        std::string body;
+        try {
+            body = render_();
+        } catch (const std::exception& e) {
+            spdlog::warn("Metrics render failed: {}", e.what());
+        }
+        response = "HTTP/1.1 200 OK\r\n"
+                   "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                   "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                   "Connection: close\r\n\r\n" + body;
+    } else {
+        response = "HTTP/1.1 404 Not Found\r\n"
+                   "Content-Length: 0\r\n"
+                   "Connection: close\r\n\r\n";
+    }
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t w = send(client_fd, response.data() + sent, response.size() - sent,
+                         MSG_NOSIGNAL);
+        if (w <= 0) {
+            break;
+        }
+        sent += static_cast<size_t>(w);
+    }
+}
+
+} // namespace uwb_bridge
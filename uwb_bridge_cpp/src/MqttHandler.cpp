@@ -14,9 +14,9 @@ void ActionListener::on_failure(const mqtt::token& tok) {
 }
 
 void ActionListener::on_success(const mqtt::token& tok) {
-    spdlog::debug("MQTT action '{}' succeeded", name_);
+    SPDLOG_DEBUG("MQTT action '{}' succeeded", name_);
     if (tok.get_message_id() != 0) {
-        spdlog::debug("  Message ID: {}", tok.get_message_id());
+        SPDLOG_DEBUG("  Message ID: {}", tok.get_message_id());
     }
 }
 
@@ -54,6 +54,7 @@ void Callback::reconnect() {
 }
 
 void Callback::connection_lost(const std::string& cause) {
+    connections_lost_.fetch_add(1, std::memory_order_relaxed);
     spdlog::error("Connection lost!");
     if (!cause.empty()) {
         spdlog::error("  Cause: {}", cause);
@@ -65,16 +66,14 @@ void Callback::connection_lost(const std::string& cause) {
 
 void Callback::message_arrived(mqtt::const_message_ptr msg) {
     try {
-        std::string topic = msg->get_topic();
-        std::string payload = msg->to_string();
-        
-        spdlog::debug("Message arrived - Topic: {}, Payload size: {} bytes", 
-                     topic, payload.size());
-        
-        // Call the user's callback function
+        SPDLOG_DEBUG("Message arrived - Topic: {}, Payload size: {} bytes",
+                     msg->get_topic(), msg->get_payload().size());
+
+        // Hand the message straight through - no payload copy, the consumer
+        // shares ownership of the Paho message object
         if (message_callback_) {
-            spdlog::debug("Invoking user message callback...");
-            message_callback_(topic, payload);
+            SPDLOG_DEBUG("Invoking user message callback...");
+            message_callback_(std::move(msg));
         } else {
             spdlog::error("Message callback is NULL! Cannot process message.");
         }
@@ -84,7 +83,11 @@ void Callback::message_arrived(mqtt::const_message_ptr msg) {
 }
 
 void Callback::delivery_complete(mqtt::delivery_token_ptr token) {
-    spdlog::trace("Delivery complete for message ID: {}", token->get_message_id());
+    spdlog::trace("Delivery complete for message ID: {}",
+                  token ? token->get_message_id() : -1);
+    if (delivery_callback_) {
+        delivery_callback_(std::move(token));
+    }
 }
 
 void Callback::on_failure(const mqtt::token& tok) {
@@ -95,19 +98,22 @@ void Callback::on_failure(const mqtt::token& tok) {
 void Callback::on_success(const mqtt::token& tok) {
     spdlog::info("Successfully reconnected!");
     reconnect_attempts_ = 0;
-    
+
     // Resubscribe to topic only if not empty
-    if (source_topic_.empty()) {
+    if (!source_topic_.empty()) {
+        try {
+            client_.subscribe(source_topic_, qos_, nullptr, sub_listener_);
+            spdlog::info("Resubscribed to topic: {}", source_topic_);
+        } catch (const mqtt::exception& exc) {
+            spdlog::error("Failed to resubscribe: {}", exc.what());
+        }
+    } else {
         spdlog::info("No topic to resubscribe - publish-only mode");
-        return;
     }
-    
-    // Resubscribe to topic
-    try {
-        client_.subscribe(source_topic_, qos_, nullptr, sub_listener_);
-        spdlog::info("Resubscribed to topic: {}", source_topic_);
-    } catch (const mqtt::exception& exc) {
-        spdlog::error("Failed to resubscribe: {}", exc.what());
+
+    // Kick off the offline-spool drain now that the broker is back
+    if (reconnect_callback_) {
+        reconnect_callback_();
     }
 }
 
@@ -195,11 +201,34 @@ MqttHandler::MqttHandler(const MqttConfig& config, MessageCallback callback)
         config_.qos,
         message_callback_);
 
+    // Account for broker delivery confirmations (pipelined publish)
+    callback_->set_delivery_callback([this](mqtt::delivery_token_ptr token) {
+        onDeliveryComplete(std::move(token));
+    });
+
+    // Offline spool: buffer publishes during outages and replay on reconnect
+    spool_enabled_ = config_.spool_memory_kb > 0;
+    if (spool_enabled_) {
+        OfflineSpool::Options opts;
+        opts.max_memory_bytes = static_cast<size_t>(config_.spool_memory_kb) * 1024;
+        opts.max_file_bytes = static_cast<size_t>(config_.spool_file_mb) * 1024 * 1024;
+        opts.file_path = config_.spool_file;
+        opts.max_age = std::chrono::milliseconds(config_.spool_max_age_ms);
+        spool_.configure(opts);
+        callback_->set_reconnect_callback([this] { startSpoolDrain(); });
+        spdlog::info("Offline spool enabled: {} KiB memory, {} overflow, {} ms max age",
+                     config_.spool_memory_kb,
+                     config_.spool_file.empty() ? "no file"
+                                                : config_.spool_file,
+                     config_.spool_max_age_ms);
+    }
+
     client_->set_callback(*callback_);
 }
 
 MqttHandler::~MqttHandler() {
     try {
+        stopSpoolDrain();
         if (client_ && client_->is_connected()) {
             spdlog::info("Disconnecting MQTT client...");
             disconnect();
@@ -217,7 +246,14 @@ bool MqttHandler::connect() {
         tok->wait();  // Wait for connection to complete
         
         spdlog::info("Connected to MQTT broker successfully");
-        
+
+        // Tokens from a previous session are never confirmed - reset accounting
+        {
+            std::lock_guard<std::mutex> lock(inflight_mutex_);
+            inflight_sent_.clear();
+            in_flight_ = 0;
+        }
+
         // Subscribe to source topic only if it's not empty (for publish-only handlers)
         if (!config_.source_topic.empty()) {
             spdlog::info("Subscribing to topic: {} (QoS {})", 
@@ -231,9 +267,14 @@ bool MqttHandler::connect() {
         }
         
         connected_ = true;
-        
+
+        // Entries spooled before/between connects drain now
+        if (spool_enabled_ && !spool_.empty()) {
+            startSpoolDrain();
+        }
+
         return true;
-        
+
     } catch (const mqtt::exception& e) {
         spdlog::error("MQTT connection failed: {}", e.what());
         connected_ = false;
@@ -242,6 +283,7 @@ bool MqttHandler::connect() {
 }
 
 void MqttHandler::disconnect() {
+    stopSpoolDrain();
     try {
         if (client_ && client_->is_connected()) {
             spdlog::info("Disconnecting from MQTT broker...");
@@ -255,40 +297,193 @@ void MqttHandler::disconnect() {
 }
 
 bool MqttHandler::publish(const std::string& topic, const std::string& payload, int qos) {
-    spdlog::debug("MqttHandler::publish() called - topic: {}, payload size: {}", topic, payload.size());
-    
+    SPDLOG_DEBUG("MqttHandler::publish() called - topic: {}, payload size: {}", topic, payload.size());
+
     if (!client_->is_connected()) {
+        if (spool_enabled_ && spool_.offer(topic, payload)) {
+            SPDLOG_DEBUG("Broker down - spooled publish to {}", topic);
+            return true;  // Accepted for delivery on reconnect
+        }
         spdlog::warn("Cannot publish - not connected to broker");
         return false;
     }
 
+    bool ok = publishConnected(topic, payload, qos);
+    if (!ok && !client_->is_connected() &&
+        spool_enabled_ && spool_.offer(topic, payload)) {
+        // Connection dropped mid-publish - the spool catches it
+        SPDLOG_DEBUG("Publish failed on dropped connection - spooled to {}", topic);
+        return true;
+    }
+    return ok;
+}
+
+bool MqttHandler::publishConnected(const std::string& topic, const std::string& payload,
+                                   int qos) {
+    // Backpressure: cap the ring of unconfirmed QoS>0 publishes so Paho
+    // never buffers unboundedly during broker slowdowns. Callers treat a
+    // false return as a failed publish; the conflation queue upstream keeps
+    // the newest position per tag until capacity frees up.
+    int actual_qos = (qos >= 0) ? qos : config_.qos;
+    if (actual_qos > 0 && config_.max_in_flight > 0 &&
+        in_flight_.load(std::memory_order_relaxed) >= config_.max_in_flight) {
+        backpressured_++;
+        SPDLOG_DEBUG("Publish backpressured - {} messages in flight", in_flight_.load());
+        return false;
+    }
+
     try {
-        int actual_qos = (qos >= 0) ? qos : config_.qos;
-        
-        spdlog::debug("Creating MQTT message...");
+        SPDLOG_DEBUG("Creating MQTT message...");
         mqtt::message_ptr pubmsg = mqtt::make_message(topic, payload);
         pubmsg->set_qos(actual_qos);
-        
-        spdlog::debug("Calling client_->publish() (async, no wait)...");
+
+        SPDLOG_DEBUG("Calling client_->publish() (async, no wait)...");
         // Use async publish without wait() to avoid deadlock in callback thread
-        auto token = client_->publish(pubmsg);
-        
-        spdlog::debug("Publish initiated (token created)");
+        if (actual_qos > 0) {
+            // On a fast broker Paho can fire delivery_complete on its
+            // consumer thread before publish() returns, so registering the
+            // token must be atomic with the publish itself:
+            // onDeliveryComplete() takes this mutex too and blocks until
+            // the map entry and counter are in place. Registering after the
+            // fact would drop that completion and permanently leak one
+            // in-flight slot per occurrence.
+            std::lock_guard<std::mutex> lock(inflight_mutex_);
+            auto token = client_->publish(pubmsg);
+            if (token) {
+                inflight_sent_[token->get_message_id()] =
+                    std::chrono::high_resolution_clock::now();
+                in_flight_++;
+            } else {
+                delivered_++;
+            }
+        } else {
+            // QoS 0 is fire-and-forget - count it as delivered immediately
+            client_->publish(pubmsg);
+            delivered_++;
+        }
+
+        SPDLOG_DEBUG("Publish initiated (token created)");
         messages_published_++;
         spdlog::trace("Published to {}: {} bytes", topic, payload.size());
-        
+
         return true;
-        
+
     } catch (const mqtt::exception& e) {
         spdlog::error("Failed to publish message: {}", e.what());
         return false;
     }
 }
 
+void MqttHandler::startSpoolDrain() {
+    if (!spool_enabled_ || spool_.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    if (drain_active_) {
+        return;  // A drain from a previous reconnect is still running
+    }
+    if (drain_thread_.joinable()) {
+        drain_thread_.join();  // Reap the finished previous drain
+    }
+
+    drain_stop_ = false;
+    drain_active_ = true;
+    drain_thread_ = std::thread(&MqttHandler::spoolDrainLoop, this);
+}
+
+void MqttHandler::stopSpoolDrain() {
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    drain_stop_ = true;
+    if (drain_thread_.joinable()) {
+        drain_thread_.join();
+    }
+}
+
+void MqttHandler::spoolDrainLoop() {
+    const auto send_interval = config_.spool_drain_rate > 0
+        ? std::chrono::microseconds(1000000 / config_.spool_drain_rate)
+        : std::chrono::microseconds(0);
+    const size_t backlog = spool_.getStats().pending;
+    spdlog::info("Draining offline spool: {} pending publishes ({} msg/sec cap)",
+                 backlog, config_.spool_drain_rate);
+
+    uint64_t replayed = 0;
+    std::string topic, payload;
+    while (!drain_stop_ && spool_.peek(topic, payload)) {
+        if (!client_->is_connected()) {
+            // Outage again - leave the remainder for the next reconnect
+            break;
+        }
+        if (publishConnected(topic, payload, -1)) {
+            spool_.pop();
+            replayed++;
+            spool_replayed_.fetch_add(1, std::memory_order_relaxed);
+            if (send_interval.count() > 0) {
+                std::this_thread::sleep_for(send_interval);
+            }
+        } else {
+            // Backpressured (or a transient failure): retry the same entry
+            // after a short pause so replay order is preserved
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    spdlog::info("Offline spool drain finished: {} publishes replayed, {} left",
+                 replayed, spool_.getStats().pending);
+    drain_active_ = false;
+}
+
+void MqttHandler::onDeliveryComplete(mqtt::delivery_token_ptr token) {
+    if (!token) {
+        return;
+    }
+
+    auto now = std::chrono::high_resolution_clock::now();
+    bool found = false;
+    std::chrono::high_resolution_clock::time_point sent;
+    {
+        std::lock_guard<std::mutex> lock(inflight_mutex_);
+        auto it = inflight_sent_.find(token->get_message_id());
+        if (it != inflight_sent_.end()) {
+            sent = it->second;
+            found = true;
+            inflight_sent_.erase(it);
+            // Decrement under the same lock that registered the token so
+            // the counter can never diverge from the map contents
+            in_flight_--;
+        }
+    }
+
+    if (found) {
+        delivery_latency_.record(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - sent).count());
+    }
+    delivered_++;
+}
+
+MqttHandler::PublishStats MqttHandler::getPublishStats(bool reset_interval) const {
+    PublishStats stats;
+    stats.published = messages_published_.load();
+    stats.delivered = delivered_.load();
+    stats.backpressured = backpressured_.load();
+    stats.in_flight = in_flight_.load();
+    stats.delivery_latency = delivery_latency_.snapshot(reset_interval);
+    stats.spool_replayed = spool_replayed_.load(std::memory_order_relaxed);
+    if (spool_enabled_) {
+        stats.spool = spool_.getStats();
+    }
+    return stats;
+}
+
 bool MqttHandler::isConnected() const {
     return client_ && client_->is_connected();
 }
 
+uint64_t MqttHandler::connectionsLost() const {
+    return callback_ ? callback_->connections_lost() : 0;
+}
+
 std::string MqttHandler::getStats() const {
     std::ostringstream oss;
     oss << "MQTT Stats:\n"
@@ -0,0 +1,353 @@
+#include "OfflineSpool.hpp"
+#include <spdlog/spdlog.h>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace uwb_bridge {
+
+namespace {
+
+constexpr char kMagic[8] = {'U', 'W', 'B', 'S', 'P', 'L', '0', '1'};
+constexpr size_t kMagicSize = sizeof(kMagic);
+
+// Grow the overflow file in 8 MiB steps - outages are rarer and smaller
+// than captures, so the chunk is smaller than CaptureWriter's
+constexpr size_t kGrowChunk = 8 * 1024 * 1024;
+
+// Fixed-size record prefix: enqueue time + topic/payload lengths
+constexpr size_t kRecordHeader = sizeof(uint64_t) + 2 * sizeof(uint32_t);
+
+uint64_t steadyNowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+OfflineSpool::~OfflineSpool() {
+    close();
+}
+
+void OfflineSpool::configure(const Options& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    options_ = options;
+}
+
+bool OfflineSpool::openFileLocked() {
+    if (file_data_) {
+        return true;
+    }
+    if (options_.file_path.empty() || options_.max_file_bytes == 0) {
+        return false;
+    }
+
+    fd_ = ::open(options_.file_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        spdlog::error("Failed to create spool file {}: {}",
+                      options_.file_path, strerror(errno));
+        return false;
+    }
+
+    if (ftruncate(fd_, kGrowChunk) != 0) {
+        spdlog::error("Failed to size spool file {}: {}",
+                      options_.file_path, strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, kGrowChunk, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        spdlog::error("Failed to map spool file {}: {}",
+                      options_.file_path, strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    file_data_ = static_cast<char*>(mapping);
+    file_mapped_size_ = kGrowChunk;
+    std::memcpy(file_data_, kMagic, kMagicSize);
+    file_write_offset_ = kMagicSize;
+    file_read_offset_ = kMagicSize;
+    file_pending_ = 0;
+
+    spdlog::info("Offline spool overflow file opened: {}", options_.file_path);
+    return true;
+}
+
+bool OfflineSpool::ensureFileCapacityLocked(size_t bytes) {
+    if (file_write_offset_ + bytes <= file_mapped_size_) {
+        return true;
+    }
+
+    size_t new_size = file_mapped_size_;
+    while (file_write_offset_ + bytes > new_size) {
+        new_size += kGrowChunk;
+    }
+
+    munmap(file_data_, file_mapped_size_);
+    file_data_ = nullptr;
+
+    if (ftruncate(fd_, new_size) != 0) {
+        spdlog::error("Failed to grow spool file {}: {}",
+                      options_.file_path, strerror(errno));
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, new_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        spdlog::error("Failed to remap spool file {}: {}",
+                      options_.file_path, strerror(errno));
+        return false;
+    }
+
+    file_data_ = static_cast<char*>(mapping);
+    file_mapped_size_ = new_size;
+    return true;
+}
+
+bool OfflineSpool::spillOldestLocked() {
+    if (entries_.empty()) {
+        return false;
+    }
+
+    const Entry& front = entries_.front();
+    const uint32_t topic_len = static_cast<uint32_t>(front.topic.size());
+    const uint32_t payload_len = static_cast<uint32_t>(front.payload.size());
+    const size_t record_size = kRecordHeader + topic_len + payload_len;
+
+    if (!openFileLocked() ||
+        file_write_offset_ + record_size > options_.max_file_bytes ||
+        !ensureFileCapacityLocked(record_size)) {
+        return false;
+    }
+
+    const uint64_t enqueued_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            front.enqueued.time_since_epoch()).count();
+
+    char* p = file_data_ + file_write_offset_;
+    std::memcpy(p, &enqueued_ms, sizeof(enqueued_ms)); p += sizeof(enqueued_ms);
+    std::memcpy(p, &topic_len, sizeof(topic_len));     p += sizeof(topic_len);
+    std::memcpy(p, &payload_len, sizeof(payload_len)); p += sizeof(payload_len);
+    std::memcpy(p, front.topic.data(), topic_len);     p += topic_len;
+    std::memcpy(p, front.payload.data(), payload_len);
+
+    file_write_offset_ += record_size;
+    file_pending_++;
+    spilled_++;
+
+    auto it = newest_.find(front.topic);
+    if (it != newest_.end() && it->second == entries_.begin()) {
+        newest_.erase(it);
+    }
+    memory_bytes_ -= front.topic.size() + front.payload.size();
+    entries_.pop_front();
+    return true;
+}
+
+bool OfflineSpool::offer(const std::string& topic, const std::string& payload) {
+    if (options_.max_memory_bytes == 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t bytes = topic.size() + payload.size();
+    const auto now = std::chrono::steady_clock::now();
+
+    // First relief valve: move the oldest entries to the overflow file
+    while (memory_bytes_ + bytes > options_.max_memory_bytes && !entries_.empty()) {
+        if (!spillOldestLocked()) {
+            break;  // no file configured, or the file cap is hit
+        }
+    }
+
+    if (memory_bytes_ + bytes > options_.max_memory_bytes) {
+        // Both tiers full: the newest position per topic wins, matching the
+        // conflation policy of the worker queues
+        auto it = newest_.find(topic);
+        if (it != newest_.end()) {
+            memory_bytes_ -= it->second->payload.size();
+            it->second->payload = payload;
+            it->second->enqueued = now;
+            memory_bytes_ += payload.size();
+            conflated_++;
+            return true;
+        }
+
+        // No same-topic entry to replace - evict oldest distinct topics
+        while (!entries_.empty() && memory_bytes_ + bytes > options_.max_memory_bytes) {
+            const Entry& front = entries_.front();
+            auto fit = newest_.find(front.topic);
+            if (fit != newest_.end() && fit->second == entries_.begin()) {
+                newest_.erase(fit);
+            }
+            memory_bytes_ -= front.topic.size() + front.payload.size();
+            entries_.pop_front();
+            dropped_++;
+        }
+        if (memory_bytes_ + bytes > options_.max_memory_bytes) {
+            // Single entry larger than the whole memory cap
+            dropped_++;
+            return false;
+        }
+    }
+
+    entries_.push_back(Entry{topic, payload, now});
+    newest_[topic] = std::prev(entries_.end());
+    memory_bytes_ += bytes;
+    spooled_++;
+    return true;
+}
+
+bool OfflineSpool::readFileRecordLocked(std::string& topic, std::string& payload,
+                                        uint64_t& enqueued_ms,
+                                        size_t& record_size) const {
+    if (file_read_offset_ + kRecordHeader > file_write_offset_) {
+        return false;
+    }
+
+    const char* p = file_data_ + file_read_offset_;
+    uint32_t topic_len, payload_len;
+    std::memcpy(&enqueued_ms, p, sizeof(enqueued_ms)); p += sizeof(enqueued_ms);
+    std::memcpy(&topic_len, p, sizeof(topic_len));     p += sizeof(topic_len);
+    std::memcpy(&payload_len, p, sizeof(payload_len)); p += sizeof(payload_len);
+
+    record_size = kRecordHeader + topic_len + payload_len;
+    if (file_read_offset_ + record_size > file_write_offset_) {
+        return false;
+    }
+
+    topic.assign(p, topic_len);
+    payload.assign(p + topic_len, payload_len);
+    return true;
+}
+
+bool OfflineSpool::peek(std::string& topic, std::string& payload) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint64_t now_ms = steadyNowMs();
+    const uint64_t max_age_ms = static_cast<uint64_t>(options_.max_age.count());
+
+    // File tier first: every spilled record is older than the memory tier
+    while (fileHasPendingLocked()) {
+        uint64_t enqueued_ms;
+        size_t record_size;
+        if (!readFileRecordLocked(topic, payload, enqueued_ms, record_size)) {
+            // Truncated record - abandon the rest of the file tier
+            spdlog::warn("Offline spool overflow file corrupt - discarding {} records",
+                         file_pending_);
+            file_read_offset_ = file_write_offset_;
+            file_pending_ = 0;
+            break;
+        }
+        if (now_ms - enqueued_ms > max_age_ms) {
+            file_read_offset_ += record_size;
+            file_pending_--;
+            expired_++;
+            continue;
+        }
+        return true;
+    }
+
+    while (!entries_.empty()) {
+        const Entry& front = entries_.front();
+        const uint64_t enqueued_ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                front.enqueued.time_since_epoch()).count();
+        if (now_ms - enqueued_ms > max_age_ms) {
+            auto it = newest_.find(front.topic);
+            if (it != newest_.end() && it->second == entries_.begin()) {
+                newest_.erase(it);
+            }
+            memory_bytes_ -= front.topic.size() + front.payload.size();
+            entries_.pop_front();
+            expired_++;
+            continue;
+        }
+        topic = front.topic;
+        payload = front.payload;
+        return true;
+    }
+
+    return false;
+}
+
+void OfflineSpool::pop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (fileHasPendingLocked()) {
+        const char* p = file_data_ + file_read_offset_ + sizeof(uint64_t);
+        uint32_t topic_len, payload_len;
+        std::memcpy(&topic_len, p, sizeof(topic_len));
+        std::memcpy(&payload_len, p + sizeof(topic_len), sizeof(payload_len));
+        file_read_offset_ += kRecordHeader + topic_len + payload_len;
+        file_pending_--;
+
+        if (!fileHasPendingLocked()) {
+            // Fully drained - rewind so the file space is reused next outage
+            file_write_offset_ = kMagicSize;
+            file_read_offset_ = kMagicSize;
+        }
+        return;
+    }
+
+    if (!entries_.empty()) {
+        const Entry& front = entries_.front();
+        auto it = newest_.find(front.topic);
+        if (it != newest_.end() && it->second == entries_.begin()) {
+            newest_.erase(it);
+        }
+        memory_bytes_ -= front.topic.size() + front.payload.size();
+        entries_.pop_front();
+    }
+}
+
+bool OfflineSpool::empty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.empty() && !fileHasPendingLocked();
+}
+
+OfflineSpool::Stats OfflineSpool::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.spooled = spooled_;
+    stats.dropped = dropped_;
+    stats.conflated = conflated_;
+    stats.expired = expired_;
+    stats.spilled = spilled_;
+    stats.pending = entries_.size() + file_pending_;
+    stats.memory_bytes = memory_bytes_;
+    return stats;
+}
+
+void OfflineSpool::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    newest_.clear();
+    memory_bytes_ = 0;
+
+    if (file_data_) {
+        munmap(file_data_, file_mapped_size_);
+        file_data_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        // The spool is transient - leave an empty file, not stale records
+        if (ftruncate(fd_, 0) != 0) {
+            spdlog::warn("Failed to trim spool file {}: {}",
+                         options_.file_path, strerror(errno));
+        }
+        ::close(fd_);
+        fd_ = -1;
+    }
+    file_mapped_size_ = 0;
+    file_write_offset_ = 0;
+    file_read_offset_ = 0;
+    file_pending_ = 0;
+}
+
+} // namespace uwb_bridge
@@ -0,0 +1,279 @@
+#include "ShmRing.hpp"
+#include <spdlog/spdlog.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace uwb_bridge {
+
+namespace {
+constexpr char kMagic[8] = {'U', 'W', 'B', 'S', 'H', 'M', '0', '1'};
+
+uint32_t roundUpPowerOfTwo(uint32_t v) {
+    uint32_t p = 1;
+    while (p < v) {
+        p <<= 1;
+    }
+    return p;
+}
+} // namespace
+
+/**
+ * @brief Shared header at the start of the mapping
+ *
+ * The head counter lives on its own cache line so writer claims never
+ * false-share with the (read-only) geometry fields.
+ */
+struct ShmRingHeader {
+    char magic[8];
+    uint32_t record_size;
+    uint32_t capacity;
+    alignas(64) std::atomic<uint64_t> head;  ///< Total records ever published
+};
+
+// ---------------------------------------------------------------------------
+// ShmRingWriter
+// ---------------------------------------------------------------------------
+
+ShmRingWriter::~ShmRingWriter() {
+    close();
+}
+
+bool ShmRingWriter::open(const std::string& name, uint32_t capacity) {
+    if (isOpen()) {
+        return false;
+    }
+    if (name.empty() || name[0] != '/') {
+        spdlog::error("Shared-memory ring name must start with '/': '{}'", name);
+        return false;
+    }
+
+    capacity_ = roundUpPowerOfTwo(capacity == 0 ? 1 : capacity);
+
+    // Recreate from scratch so stale rings from a previous run never leak
+    // half-written records into a new session
+    shm_unlink(name.c_str());
+    fd_ = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd_ < 0) {
+        spdlog::error("Failed to create shared-memory ring '{}': {}",
+                      name, std::strerror(errno));
+        return false;
+    }
+
+    mapped_size_ = sizeof(ShmRingHeader) + static_cast<size_t>(capacity_) * sizeof(ShmPositionRecord);
+    if (ftruncate(fd_, static_cast<off_t>(mapped_size_)) != 0) {
+        spdlog::error("Failed to size shared-memory ring '{}': {}",
+                      name, std::strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        spdlog::error("Failed to map shared-memory ring '{}': {}",
+                      name, std::strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    header_ = static_cast<ShmRingHeader*>(mapping);
+    std::memcpy(header_->magic, kMagic, sizeof(kMagic));
+    header_->record_size = sizeof(ShmPositionRecord);
+    header_->capacity = capacity_;
+    header_->head.store(0, std::memory_order_relaxed);
+
+    slots_ = reinterpret_cast<ShmPositionRecord*>(
+        reinterpret_cast<char*>(mapping) + sizeof(ShmRingHeader));
+    // ftruncate zero-fills, so every slot starts with seq == 0 (invalid)
+
+    name_ = name;
+    spdlog::info("Shared-memory ring '{}' open: {} slots x {} bytes",
+                 name, capacity_, sizeof(ShmPositionRecord));
+    return true;
+}
+
+void ShmRingWriter::publish(const std::string& tag_id, double x, double y, double z,
+                            double timestamp, uint64_t published_us, uint8_t units) {
+    // Claim a slot: one uncontended-in-the-common-case fetch_add, no locks
+    const uint64_t index = header_->head.fetch_add(1, std::memory_order_acq_rel);
+    ShmPositionRecord& slot = slots_[index & (capacity_ - 1)];
+
+    // Invalidate the slot before touching the payload so a concurrent reader
+    // can never validate a half-overwritten record against the old seq. The
+    // acquire side of the RMW pins the payload stores below the
+    // invalidation - a plain release store only orders what comes before
+    // it, so the payload could become visible first and a reader that
+    // sampled the old seq just before our claim would validate a torn copy
+    slot.seq.exchange(0, std::memory_order_acq_rel);
+
+    slot.timestamp = timestamp;
+    slot.published_us = published_us;
+    slot.x = x;
+    slot.y = y;
+    slot.z = z;
+    slot.units = units;
+    const size_t len = tag_id.size() < sizeof(slot.tag_id)
+        ? tag_id.size() : sizeof(slot.tag_id);
+    slot.tag_len = static_cast<uint8_t>(len);
+    std::memcpy(slot.tag_id, tag_id.data(), len);
+
+    // Publish: readers accept the copy only if seq reads index + 1 on both
+    // sides of it
+    slot.seq.store(index + 1, std::memory_order_release);
+}
+
+uint64_t ShmRingWriter::recordCount() const {
+    return header_ ? header_->head.load(std::memory_order_relaxed) : 0;
+}
+
+void ShmRingWriter::close() {
+    if (header_) {
+        munmap(header_, mapped_size_);
+        header_ = nullptr;
+        slots_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    if (!name_.empty()) {
+        shm_unlink(name_.c_str());
+        name_.clear();
+    }
+    mapped_size_ = 0;
+    capacity_ = 0;
+}
+
+// ---------------------------------------------------------------------------
+// ShmRingReader
+// ---------------------------------------------------------------------------
+
+ShmRingReader::~ShmRingReader() {
+    close();
+}
+
+bool ShmRingReader::open(const std::string& name) {
+    if (isOpen()) {
+        return false;
+    }
+
+    fd_ = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd_ < 0) {
+        spdlog::error("Failed to open shared-memory ring '{}': {}",
+                      name, std::strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0 ||
+        static_cast<size_t>(st.st_size) < sizeof(ShmRingHeader)) {
+        spdlog::error("Shared-memory ring '{}' is truncated", name);
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    mapped_size_ = static_cast<size_t>(st.st_size);
+
+    const void* mapping = mmap(nullptr, mapped_size_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        spdlog::error("Failed to map shared-memory ring '{}': {}",
+                      name, std::strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    const auto* header = static_cast<const ShmRingHeader*>(mapping);
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 ||
+        header->record_size != sizeof(ShmPositionRecord)) {
+        spdlog::error("Shared-memory ring '{}' has an incompatible layout", name);
+        munmap(const_cast<void*>(mapping), mapped_size_);
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    header_ = header;
+    capacity_ = header->capacity;
+    slots_ = reinterpret_cast<const ShmPositionRecord*>(
+        static_cast<const char*>(mapping) + sizeof(ShmRingHeader));
+
+    // Start at the current head: a new consumer sees live traffic, not a
+    // replay of whatever is still sitting in the ring
+    cursor_ = header->head.load(std::memory_order_acquire);
+    return true;
+}
+
+bool ShmRingReader::next(ShmPositionRecord& out) {
+    if (!isOpen()) {
+        return false;
+    }
+
+    for (;;) {
+        const uint64_t head = header_->head.load(std::memory_order_acquire);
+        if (cursor_ >= head) {
+            return false;  // Caught up
+        }
+        // Lapped: jump to the oldest slot the writer can no longer be inside
+        // of (one full ring behind head is already being reclaimed)
+        const uint64_t oldest = head > capacity_ ? head - capacity_ : 0;
+        if (cursor_ < oldest) {
+            dropped_ += oldest - cursor_;
+            cursor_ = oldest;
+        }
+
+        const ShmPositionRecord& slot = slots_[cursor_ & (capacity_ - 1)];
+        const uint64_t seq_before = slot.seq.load(std::memory_order_acquire);
+        if (seq_before != cursor_ + 1) {
+            // Writer is mid-overwrite of this slot; it will land ahead of us
+            dropped_++;
+            cursor_++;
+            continue;
+        }
+
+        out.timestamp = slot.timestamp;
+        out.published_us = slot.published_us;
+        out.x = slot.x;
+        out.y = slot.y;
+        out.z = slot.z;
+        out.units = slot.units;
+        out.tag_len = slot.tag_len;
+        std::memcpy(out.tag_id, slot.tag_id, sizeof(out.tag_id));
+
+        // Re-check seq after the copy: unchanged means the copy is consistent
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == seq_before) {
+            out.seq.store(seq_before, std::memory_order_relaxed);
+            cursor_++;
+            return true;
+        }
+        // Torn copy (writer lapped us mid-read); retry from the new head
+        dropped_++;
+        cursor_++;
+    }
+}
+
+void ShmRingReader::close() {
+    if (header_) {
+        munmap(const_cast<ShmRingHeader*>(header_), mapped_size_);
+        header_ = nullptr;
+        slots_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    mapped_size_ = 0;
+    capacity_ = 0;
+    cursor_ = 0;
+}
+
+} // namespace uwb_bridge
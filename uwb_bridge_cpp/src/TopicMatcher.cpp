@@ -0,0 +1,107 @@
+#include "TopicMatcher.hpp"
+
+#include <algorithm>
+
+namespace uwb_bridge {
+
+TopicMatcher::TopicMatcher() {
+    nodes_.emplace_back();  // Root
+}
+
+int TopicMatcher::childFor(int node, std::string_view segment) {
+    for (const auto& edge : nodes_[node].edges) {
+        if (edge.first == segment) {
+            return edge.second;
+        }
+    }
+    int child = static_cast<int>(nodes_.size());
+    nodes_[node].edges.emplace_back(std::string(segment), child);
+    nodes_.emplace_back();  // May reallocate; done after the emplace above
+    return child;
+}
+
+void TopicMatcher::addPattern(std::string_view prefix, int route) {
+    if (prefix.empty()) {
+        nodes_[0].route = route;
+        return;
+    }
+
+    // Walk/create full-segment nodes for everything before the last '/'
+    int node = 0;
+    std::string_view rest = prefix;
+    size_t slash;
+    while ((slash = rest.find('/')) != std::string_view::npos) {
+        node = childFor(node, rest.substr(0, slash));
+        rest = rest.substr(slash + 1);
+    }
+
+    if (rest.empty()) {
+        // Pattern ends in '/': matches any topic passing through this node
+        nodes_[node].route = route;
+    } else {
+        // Trailing piece without a slash: prefix-match within that segment,
+        // kept longest-first so the longest pattern wins at equal depth
+        auto& partials = nodes_[node].partials;
+        partials.emplace_back(std::string(rest), route);
+        std::sort(partials.begin(), partials.end(),
+                  [](const auto& a, const auto& b) {
+                      return a.first.size() > b.first.size();
+                  });
+    }
+}
+
+TopicMatcher::Match TopicMatcher::match(std::string_view topic) const {
+    Match result;
+    result.route = nodes_[0].route;
+    result.tag_id = extractTagId(topic);
+
+    // Single left-to-right walk; deeper trie hits correspond to longer
+    // string prefixes, so overwriting as we descend yields longest-wins
+    int node = 0;
+    std::string_view rest = topic;
+    while (!rest.empty()) {
+        size_t slash = rest.find('/');
+        std::string_view segment =
+            (slash == std::string_view::npos) ? rest : rest.substr(0, slash);
+
+        // Partial-segment patterns at this depth (checked longest-first;
+        // beaten below by any full-edge descent, which is a longer prefix)
+        for (const auto& partial : nodes_[node].partials) {
+            if (segment.substr(0, partial.first.size()) == partial.first) {
+                result.route = partial.second;
+                break;
+            }
+        }
+
+        // Full-segment edge: descend and pick up any route ending here
+        int next = -1;
+        for (const auto& edge : nodes_[node].edges) {
+            if (edge.first == segment) {
+                next = edge.second;
+                break;
+            }
+        }
+        if (next < 0 || slash == std::string_view::npos) {
+            break;
+        }
+        node = next;
+        // Patterns ending in '/' at this depth require the topic to contain
+        // that slash, which it does - the segment had a separator after it
+        if (nodes_[node].route >= 0) {
+            result.route = nodes_[node].route;
+        }
+        rest = rest.substr(slash + 1);
+    }
+
+    return result;
+}
+
+std::string_view TopicMatcher::extractTagId(std::string_view topic) {
+    size_t last_slash = topic.find_last_of('/');
+    if (last_slash != std::string_view::npos && last_slash + 1 < topic.size()) {
+        return topic.substr(last_slash + 1);
+    }
+    return std::string_view("unknown");
+}
+
+} // namespace uwb_bridge
@@ -2,6 +2,7 @@
 #include "ConfigLoader.hpp"
 #include "FirestoreManager.hpp"
 #include <spdlog/spdlog.h>
+#include <spdlog/async.h>
 #include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <csignal>
@@ -50,8 +51,14 @@ void setupLogging(const uwb_bridge::AppConfig& config) {
         }
     }
 
-    // Create and register logger
-    auto logger = std::make_shared<spdlog::logger>("uwb_bridge", sinks.begin(), sinks.end());
+    // Create and register an async logger: log calls only format into a
+    // bounded ring buffer and a dedicated thread does the sink I/O, so a
+    // slow disk or console can never stall the MQTT callback or a worker.
+    // overrun_oldest drops the oldest queued lines instead of blocking.
+    spdlog::init_thread_pool(8192, 1);
+    auto logger = std::make_shared<spdlog::async_logger>(
+        "uwb_bridge", sinks.begin(), sinks.end(), spdlog::thread_pool(),
+        spdlog::async_overflow_policy::overrun_oldest);
     logger->set_level(spdlog::level::from_str(config.log_level));
     logger->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] [%t] %v");
     spdlog::set_default_logger(logger);
@@ -81,6 +88,8 @@ void printUsage(const char* program_name) {
     std::cout << "Options:\n";
     std::cout << "  -c, --config <file>    Configuration file path (default: config/app_config.json)\n";
     std::cout << "  -f, --firestore        Use Firebase Firestore for configuration (ignores -c option)\n";
+    std::cout << "  -r, --replay <file>    Replay a capture log through the pipeline, then exit\n";
+    std::cout << "      --paced            Replay at recorded pacing (default: as fast as possible)\n";
     std::cout << "  -h, --help             Show this help message\n";
     std::cout << "  -v, --version          Show version information\n";
     std::cout << "\n";
@@ -102,6 +111,8 @@ int main(int argc, char* argv[]) {
     // Default configuration path
     std::string config_path = "config/app_config.json";
     bool use_firestore = false;
+    std::string replay_file;
+    bool replay_paced = false;
 
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
@@ -118,6 +129,10 @@ int main(int argc, char* argv[]) {
             use_firestore = false;
         } else if (arg == "-f" || arg == "--firestore") {
             use_firestore = true;
+        } else if ((arg == "-r" || arg == "--replay") && i + 1 < argc) {
+            replay_file = argv[++i];
+        } else if (arg == "--paced") {
+            replay_paced = true;
         } else {
             std::cerr << "Unknown option: " << arg << "\n\n";
             printUsage(argv[0]);
@@ -129,29 +144,39 @@ int main(int argc, char* argv[]) {
         uwb_bridge::AppConfig config;
         std::shared_ptr<uwb_transform::FloorplanTransformer> transformer;
 
+        bool firestore_from_cache = false;
+
         if (use_firestore) {
             // ===== FIRESTORE MODE =====
             spdlog::info("Using Firebase Firestore for configuration");
 
-            // 1. Initialize Firestore
-            g_firestore = std::make_unique<uwb_bridge::FirestoreManager>();
-            if (!g_firestore->initialize()) {
-                spdlog::critical("Failed to initialize Firebase Firestore");
-                return 1;
-            }
+            // Fast path: start from the local write-through cache and
+            // reconcile with Firestore in the background after the bridge
+            // is serving traffic. Firebase init + auth + fetch can take
+            // 30+ seconds when the backend or uplink is unhealthy.
+            if (uwb_bridge::FirestoreManager::loadCachedConfig(config)) {
+                firestore_from_cache = true;
+                spdlog::info("Starting from cached config - Firestore reconcile will run in background");
+            } else {
+                // No cache yet (first boot): block on Firestore as before
+                g_firestore = std::make_unique<uwb_bridge::FirestoreManager>();
+                if (!g_firestore->initialize()) {
+                    spdlog::critical("Failed to initialize Firebase Firestore");
+                    return 1;
+                }
 
-            // 2. Fetch AppConfig (blocking wait on startup)
-            spdlog::info("Fetching configuration from Firestore...");
-            auto config_future = g_firestore->fetchAppConfig();
-            
-            // Wait for config with timeout
-            if (config_future.wait_for(std::chrono::seconds(10)) == std::future_status::timeout) {
-                spdlog::critical("Timeout waiting for configuration from Firestore");
-                return 1;
+                spdlog::info("Fetching configuration from Firestore...");
+                auto config_future = g_firestore->fetchAppConfig();
+
+                // Wait for config with timeout
+                if (config_future.wait_for(std::chrono::seconds(10)) == std::future_status::timeout) {
+                    spdlog::critical("Timeout waiting for configuration from Firestore");
+                    return 1;
+                }
+
+                config = config_future.get();
+                spdlog::info("Configuration loaded from Firestore successfully");
             }
-            
-            config = config_future.get();
-            spdlog::info("Configuration loaded from Firestore successfully");
 
         } else {
             // ===== LOCAL JSON FILE MODE =====
@@ -179,7 +204,7 @@ int main(int argc, char* argv[]) {
         }
 
         // If using Firestore, start the real-time listener for transform config
-        if (use_firestore && g_firestore) {
+        if (use_firestore && g_firestore && !firestore_from_cache) {
             spdlog::info("Setting up real-time Firestore listener for transform config...");
             
             // Get transformer from bridge (you'll need to add a getter method to BridgeCore)
@@ -191,7 +216,9 @@ int main(int argc, char* argv[]) {
                     config.transform.scale,
                     config.transform.rotation_rad,
                     config.transform.x_flipped,
-                    config.transform.y_flipped
+                    config.transform.y_flipped,
+                    config.transform.z_offset,
+                    config.transform.z_scale
                 }
             );
             
@@ -209,6 +236,75 @@ int main(int argc, char* argv[]) {
             return 1;
         }
 
+        // Background reconcile: the bridge is already serving from the
+        // cached config; now do the slow Firebase init + fetch off the
+        // critical path, refresh the cache, apply transform updates live
+        // and leave the real-time listener running.
+        std::thread firestore_reconcile;
+        if (use_firestore && firestore_from_cache && replay_file.empty()) {
+            firestore_reconcile = std::thread([]() {
+                auto manager = std::make_unique<uwb_bridge::FirestoreManager>();
+                if (!manager->initialize()) {
+                    spdlog::warn("Background Firestore init failed - serving from cached config");
+                    return;
+                }
+
+                auto config_future = manager->fetchAppConfig();
+                while (config_future.wait_for(std::chrono::seconds(1)) ==
+                       std::future_status::timeout) {
+                    if (g_shutdown_requested) {
+                        return;
+                    }
+                }
+
+                uwb_transform::TransformConfig tf_config;
+                try {
+                    // fetchAppConfig() already refreshed the local cache
+                    uwb_bridge::AppConfig fresh = config_future.get();
+                    tf_config = uwb_transform::TransformConfig{
+                        fresh.transform.origin_x,
+                        fresh.transform.origin_y,
+                        fresh.transform.scale,
+                        fresh.transform.rotation_rad,
+                        fresh.transform.x_flipped,
+                        fresh.transform.y_flipped,
+                        fresh.transform.z_offset,
+                        fresh.transform.z_scale
+                    };
+                    if (g_bridge) {
+                        g_bridge->updateFloorplanTransform("default", tf_config);
+                    }
+                    spdlog::info("Reconciled with Firestore - transform applied, cache refreshed");
+                } catch (const std::exception& e) {
+                    spdlog::warn("Background Firestore fetch failed ({}) - serving from cached config",
+                                 e.what());
+                    return;
+                }
+
+                // Keep receiving real-time transform updates, same as the
+                // blocking startup path
+                auto transformer =
+                    std::make_shared<uwb_transform::FloorplanTransformer>(tf_config);
+                if (manager->startTransformListener(transformer)) {
+                    spdlog::info("Firestore transform listener active");
+                }
+                g_firestore = std::move(manager);
+            });
+        }
+
+        // Replay mode: push the capture through the pipeline, print stats, exit
+        if (!replay_file.empty()) {
+            bool ok = g_bridge->replayCapture(replay_file, replay_paced);
+            g_bridge->printStats();
+            g_bridge->stop();
+            g_bridge.reset();
+            if (g_firestore) {
+                g_firestore->stopTransformListener();
+                g_firestore.reset();
+            }
+            return ok ? 0 : 1;
+        }
+
         spdlog::info("UWB Bridge running. Press Ctrl+C to stop.");
         if (use_firestore) {
             spdlog::info("Transform configuration updates from Firestore will be applied automatically.");
@@ -219,16 +315,23 @@ int main(int argc, char* argv[]) {
             std::this_thread::sleep_for(std::chrono::seconds(1));
             
             // Optionally print stats periodically (every 60 seconds)
+            // reset_interval=true so latency percentiles cover the last minute
             static int stats_counter = 0;
             if (++stats_counter >= 60) {
-                g_bridge->printStats();
+                g_bridge->printStats(true);
                 stats_counter = 0;
             }
         }
 
         // Graceful shutdown
         spdlog::info("Shutting down...");
-        
+
+        // Join the reconcile thread before touching g_firestore (it hands
+        // ownership over when it finishes)
+        if (firestore_reconcile.joinable()) {
+            firestore_reconcile.join();
+        }
+
         if (g_firestore) {
             g_firestore->stopTransformListener();
             g_firestore.reset();
@@ -0,0 +1,313 @@
+/**
+ * UWB Bridge load generator and soak tester
+ *
+ * C++ replacement for tools/load_test.py, which tops out well below the
+ * bridge's ceiling. Publishes synthetic Pozyx-format messages through the
+ * same MqttHandler the bridge uses, subscribes to the processed output
+ * topics, matches responses by an embedded sequence number (carried in the
+ * payload's top-level timestamp field, which the bridge round-trips), and
+ * reports end-to-end latency percentiles and loss.
+ *
+ * Usage:
+ *   uwb_bridge_loadgen [--host H] [--port P] [--rate MSG_PER_SEC]
+ *                      [--tags N] [--seconds S] [--qos Q]
+ *                      [--source-topic PREFIX] [--dest-topic PREFIX]
+ */
+
+#include "ConfigLoader.hpp"
+#include "LatencyHistogram.hpp"
+#include "MqttHandler.hpp"
+#include <spdlog/spdlog.h>
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct LoadgenOptions {
+    std::string host = "localhost";
+    int port = 1883;
+    int rate = 1000;          // Total messages per second across all tags
+    int tags = 50;            // Number of distinct synthetic tags
+    int seconds = 30;         // Test duration
+    int qos = 1;
+    std::string source_topic = "tags";          // Publish to <source_topic>/<tag>
+    std::string dest_topic = "processed";       // Subscribe to <dest_topic>/#
+};
+
+void printUsage(const char* prog) {
+    spdlog::info("Usage: {} [--host H] [--port P] [--rate MSG_PER_SEC] "
+                 "[--tags N] [--seconds S] [--qos Q] "
+                 "[--source-topic PREFIX] [--dest-topic PREFIX]", prog);
+}
+
+bool parseArgs(int argc, char* argv[], LoadgenOptions& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                spdlog::error("Missing value for {}", arg);
+                return nullptr;
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--help" || arg == "-h") {
+            return false;
+        } else if (arg == "--host") {
+            const char* v = next(); if (!v) return false;
+            opts.host = v;
+        } else if (arg == "--port") {
+            const char* v = next(); if (!v) return false;
+            opts.port = std::atoi(v);
+        } else if (arg == "--rate") {
+            const char* v = next(); if (!v) return false;
+            opts.rate = std::atoi(v);
+        } else if (arg == "--tags") {
+            const char* v = next(); if (!v) return false;
+            opts.tags = std::atoi(v);
+        } else if (arg == "--seconds") {
+            const char* v = next(); if (!v) return false;
+            opts.seconds = std::atoi(v);
+        } else if (arg == "--qos") {
+            const char* v = next(); if (!v) return false;
+            opts.qos = std::atoi(v);
+        } else if (arg == "--source-topic") {
+            const char* v = next(); if (!v) return false;
+            opts.source_topic = v;
+        } else if (arg == "--dest-topic") {
+            const char* v = next(); if (!v) return false;
+            opts.dest_topic = v;
+        } else {
+            spdlog::error("Unknown argument: {}", arg);
+            return false;
+        }
+    }
+
+    if (opts.rate < 1 || opts.tags < 1 || opts.seconds < 1 ||
+        opts.qos < 0 || opts.qos > 2) {
+        spdlog::error("Invalid option values (rate/tags/seconds must be >= 1, qos 0-2)");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Tracks in-flight messages by sequence number. The send timestamp is stored
+ * at the sequence's slot when published and consumed (zeroed) when the
+ * matching response arrives, so each response is counted at most once and
+ * everything left non-zero at the end is loss.
+ */
+class SequenceTracker {
+public:
+    explicit SequenceTracker(size_t capacity) : send_times_us_(capacity) {
+        for (auto& slot : send_times_us_) {
+            slot.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void recordSend(uint64_t seq, Clock::time_point when) {
+        if (seq < send_times_us_.size()) {
+            send_times_us_[seq].store(toMicros(when), std::memory_order_release);
+        }
+    }
+
+    /// Returns the send timestamp in us, or 0 if unknown/already matched
+    uint64_t consume(uint64_t seq) {
+        if (seq >= send_times_us_.size()) {
+            return 0;
+        }
+        return send_times_us_[seq].exchange(0, std::memory_order_acq_rel);
+    }
+
+    static uint64_t toMicros(Clock::time_point tp) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            tp.time_since_epoch()).count();
+    }
+
+private:
+    std::vector<std::atomic<uint64_t>> send_times_us_;
+};
+
+uwb_bridge::MqttConfig makeBrokerConfig(const LoadgenOptions& opts,
+                                        const std::string& client_id,
+                                        const std::string& subscribe_topic) {
+    uwb_bridge::MqttConfig config;
+    config.broker_address = "tcp://" + opts.host + ":" + std::to_string(opts.port);
+    config.port = 0;  // Port already embedded in the address
+    config.client_id = client_id;
+    config.source_topic = subscribe_topic;
+    config.qos = opts.qos;
+    config.keepalive_interval = 60;
+    config.clean_session = true;
+    config.use_ssl = false;
+    config.use_websockets = false;
+    config.max_in_flight = 0;  // The loadgen paces itself; don't cap publishes
+    return config;
+}
+
+/// Build a Pozyx-format payload with the sequence number as the timestamp
+std::string makePozyxPayload(const std::string& tag_id, uint64_t seq,
+                             std::mt19937& rng) {
+    std::uniform_int_distribution<int> xy(500, 50000);
+    std::uniform_int_distribution<int> z(0, 3000);
+
+    nlohmann::json msg;
+    msg["tagId"] = tag_id;
+    msg["timestamp"] = seq;
+    auto& coords = msg["data"]["coordinates"];
+    coords["x"] = xy(rng);
+    coords["y"] = xy(rng);
+    coords["z"] = z(rng);
+    return nlohmann::json::array({std::move(msg)}).dump();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    spdlog::set_pattern("[%H:%M:%S.%e] [%^%l%$] %v");
+
+    LoadgenOptions opts;
+    if (!parseArgs(argc, argv, opts)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const uint64_t total_messages =
+        static_cast<uint64_t>(opts.rate) * static_cast<uint64_t>(opts.seconds);
+
+    spdlog::info("UWB Bridge load generator");
+    spdlog::info("  Broker:   {}:{}", opts.host, opts.port);
+    spdlog::info("  Rate:     {} msg/sec for {} s ({} messages)",
+                 opts.rate, opts.seconds, total_messages);
+    spdlog::info("  Tags:     {}", opts.tags);
+    spdlog::info("  QoS:      {}", opts.qos);
+    spdlog::info("  Publish:  {}/<tag>", opts.source_topic);
+    spdlog::info("  Listen:   {}/#", opts.dest_topic);
+
+    SequenceTracker tracker(total_messages);
+    uwb_bridge::LatencyHistogram latency;
+    std::atomic<uint64_t> received{0};
+    std::atomic<uint64_t> unmatched{0};
+    std::atomic<uint64_t> parse_errors{0};
+
+    // Subscriber: match responses back to sends by the round-tripped timestamp
+    auto sub_config = makeBrokerConfig(opts, "uwb_loadgen_sub", opts.dest_topic + "/#");
+    uwb_bridge::MqttHandler subscriber(sub_config,
+        [&](mqtt::const_message_ptr msg) {
+            auto now = Clock::now();
+            try {
+                nlohmann::json j = nlohmann::json::parse(msg->get_payload());
+                const nlohmann::json& doc = (j.is_array() && !j.empty()) ? j[0] : j;
+                if (!doc.contains("timestamp")) {
+                    unmatched++;
+                    return;
+                }
+                uint64_t seq = doc["timestamp"].get<uint64_t>();
+                uint64_t sent_us = tracker.consume(seq);
+                if (sent_us == 0) {
+                    unmatched++;
+                    return;
+                }
+                latency.record(SequenceTracker::toMicros(now) - sent_us);
+                received++;
+            } catch (const nlohmann::json::exception&) {
+                parse_errors++;
+            }
+        });
+
+    // Publisher: no subscription, publish-only
+    auto pub_config = makeBrokerConfig(opts, "uwb_loadgen_pub", "");
+    uwb_bridge::MqttHandler publisher(pub_config, nullptr);
+
+    if (!subscriber.connect() || !publisher.connect()) {
+        spdlog::error("Failed to connect to broker");
+        return 1;
+    }
+
+    // Paced publish loop with absolute deadlines, so a slow publish doesn't
+    // permanently drop the achieved rate below the target
+    std::mt19937 rng(42);
+    uint64_t sent = 0;
+    uint64_t publish_failures = 0;
+    const auto interval = std::chrono::nanoseconds(1000000000ULL / opts.rate);
+    const auto start = Clock::now();
+    auto deadline = start;
+
+    for (uint64_t seq = 0; seq < total_messages; ++seq) {
+        std::this_thread::sleep_until(deadline);
+        deadline += interval;
+
+        std::string tag_id = "loadtag_" +
+            std::to_string(seq % static_cast<uint64_t>(opts.tags));
+        std::string topic = opts.source_topic + "/" + tag_id;
+        std::string payload = makePozyxPayload(tag_id, seq, rng);
+
+        tracker.recordSend(seq, Clock::now());
+        if (publisher.publish(topic, payload)) {
+            sent++;
+        } else {
+            publish_failures++;
+            tracker.consume(seq);  // Never sent - don't count it as lost
+        }
+
+        if ((seq + 1) % (static_cast<uint64_t>(opts.rate) * 10) == 0) {
+            spdlog::info("  Sent {}/{} ({} received)", seq + 1, total_messages,
+                         received.load());
+        }
+    }
+
+    auto publish_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        Clock::now() - start);
+    spdlog::info("Published {} messages in {:.2f} s ({:.1f} msg/sec achieved)",
+                 sent, publish_duration.count() / 1000.0,
+                 sent * 1000.0 / publish_duration.count());
+
+    // Grace period for in-flight responses
+    spdlog::info("Waiting for in-flight responses...");
+    uint64_t last_received = received.load();
+    for (int i = 0; i < 10; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        uint64_t now_received = received.load();
+        if (now_received >= sent || (i > 0 && now_received == last_received)) {
+            break;  // Complete, or no progress in the last interval
+        }
+        last_received = now_received;
+    }
+
+    publisher.disconnect();
+    subscriber.disconnect();
+
+    auto snap = latency.snapshot();
+    uint64_t lost = sent - received.load();
+
+    spdlog::info("=================================================");
+    spdlog::info("  Load Test Results");
+    spdlog::info("=================================================");
+    spdlog::info("Sent:             {}", sent);
+    spdlog::info("Publish failures: {}", publish_failures);
+    spdlog::info("Received:         {}", received.load());
+    spdlog::info("Lost:             {} ({:.2f}%)", lost,
+                 sent > 0 ? 100.0 * lost / sent : 0.0);
+    if (unmatched.load() > 0) {
+        spdlog::info("Unmatched:        {}", unmatched.load());
+    }
+    if (parse_errors.load() > 0) {
+        spdlog::info("Parse errors:     {}", parse_errors.load());
+    }
+    if (snap.count > 0) {
+        spdlog::info("End-to-end latency: p50={}us p90={}us p99={}us max={}us (n={})",
+                     snap.p50_us, snap.p90_us, snap.p99_us, snap.max_us, snap.count);
+    }
+    spdlog::info("=================================================");
+
+    return lost == 0 && publish_failures == 0 ? 0 : 2;
+}